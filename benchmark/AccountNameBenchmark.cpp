@@ -0,0 +1,124 @@
+#include "AuthServer/AccountName.h"
+#include "OpenHashSet.h"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Account name lookups done for each GS client login/logout/kick failed event.
+// Before: std::unordered_map keyed by a lower case copy of the name, so each lookup allocates.
+// After: OpenHashSet of clients keyed by their AccountName with case insensitive hash and comparison, no allocation.
+
+using AuthServer::AccountName;
+using AuthServer::AccountNameEqual;
+using AuthServer::AccountNameHash;
+using AuthServer::AccountNameRef;
+
+struct BenchClient {
+	uint32_t accountId;
+	AccountName account;
+};
+
+struct BenchClientHash {
+	size_t operator()(AccountNameRef account) const { return AccountNameHash()(account); }
+	size_t operator()(const BenchClient* client) const { return AccountNameHash()(client->account); }
+};
+
+struct BenchClientEqual {
+	bool operator()(const BenchClient* client, AccountNameRef account) const {
+		return AccountNameEqual()(client->account, account);
+	}
+	bool operator()(const BenchClient* client, const BenchClient* other) const {
+		return AccountNameEqual()(client->account, other->account);
+	}
+};
+
+static const int ACCOUNT_COUNT = 5000;
+static const int EVENT_COUNT = 2000000;
+
+static int toLowerChar(int c) {
+	if(c >= 'A' && c <= 'Z')
+		c += 'a' - 'A';
+
+	return c;
+}
+
+static std::string toLower(const std::string& str) {
+	std::string lcase = str;
+	std::transform(lcase.begin(), lcase.end(), lcase.begin(), toLowerChar);
+	return lcase;
+}
+
+static double nowNs() {
+	return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(
+	           std::chrono::steady_clock::now().time_since_epoch())
+	    .count();
+}
+
+int main() {
+	std::vector<BenchClient> clients(ACCOUNT_COUNT);
+	// Account fields as received in GS packets, with a case different than when the account was added
+	std::vector<std::vector<char>> packetAccounts(ACCOUNT_COUNT, std::vector<char>(AccountName::MAX_SIZE + 1));
+	std::unordered_map<std::string, BenchClient*> previousIndex;
+	OpenHashSet<BenchClient, BenchClientHash, BenchClientEqual> newIndex;
+
+	for(int i = 0; i < ACCOUNT_COUNT; i++) {
+		char account[AccountName::MAX_SIZE + 1];
+
+		snprintf(account, sizeof(account), "PlayerAccount%d", i);
+		clients[i].accountId = i;
+		previousIndex.insert(std::make_pair(toLower(account), &clients[i]));
+		clients[i].account.assign(account, strlen(account));
+		newIndex.insert(&clients[i]);
+
+		snprintf(packetAccounts[i].data(), AccountName::MAX_SIZE + 1, "playeraccount%d", i);
+	}
+
+	unsigned int found = 0;
+	double start = nowNs();
+	for(int i = 0; i < EVENT_COUNT; i++) {
+		const char* packetAccount = packetAccounts[i % ACCOUNT_COUNT].data();
+		std::string account(packetAccount, strnlen(packetAccount, AccountName::MAX_SIZE));
+		auto it = previousIndex.find(toLower(account));
+		if(it != previousIndex.end())
+			found += it->second->accountId;
+	}
+	double previousDuration = nowNs() - start;
+
+	start = nowNs();
+	for(int i = 0; i < EVENT_COUNT; i++) {
+		const char* packetAccount = packetAccounts[i % ACCOUNT_COUNT].data();
+		std::string account(packetAccount, strnlen(packetAccount, AccountName::MAX_SIZE));
+		BenchClient* client = newIndex.find(AccountNameRef(account));
+		if(client)
+			found -= client->accountId;
+	}
+	double newDuration = nowNs() - start;
+
+	start = nowNs();
+	for(int i = 0; i < EVENT_COUNT; i++) {
+		const char* packetAccount = packetAccounts[i % ACCOUNT_COUNT].data();
+		BenchClient* client =
+		    newIndex.find(AccountNameRef(packetAccount, strnlen(packetAccount, AccountName::MAX_SIZE)));
+		if(client)
+			found += client->accountId;
+	}
+	double directDuration = nowNs() - start;
+
+	printf("%d connected accounts, %d GS events\n", ACCOUNT_COUNT, EVENT_COUNT);
+	printf("unordered_map + toLower copy     %8.1f ns/event  %6.2f Mevents/s\n",
+	       previousDuration / EVENT_COUNT,
+	       EVENT_COUNT * 1e3 / previousDuration);
+	printf("AccountName index                %8.1f ns/event  %6.2f Mevents/s\n",
+	       newDuration / EVENT_COUNT,
+	       EVENT_COUNT * 1e3 / newDuration);
+	printf("AccountName index, packet field  %8.1f ns/event  %6.2f Mevents/s\n",
+	       directDuration / EVENT_COUNT,
+	       EVENT_COUNT * 1e3 / directDuration);
+
+	// Keep the lookups from being optimized out
+	return found == (unsigned int) -1 ? 1 : 0;
+}
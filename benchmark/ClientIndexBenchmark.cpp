@@ -0,0 +1,169 @@
+#include "AuthServer/ClientIndex.h"
+#include "uv.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Login/logout contention on the connected clients registry, like auth and GS events do concurrently.
+// Compare ClientIndex with the previous single lock over two std::unordered_map.
+
+struct BenchClient {
+	uint32_t accountId;
+	std::string account;
+};
+
+class GlobalLockIndex {
+public:
+	GlobalLockIndex() { uv_mutex_init(&lock); }
+	~GlobalLockIndex() { uv_mutex_destroy(&lock); }
+
+	template<class Factory>
+	BenchClient* tryAdd(uint32_t accountId, const std::string& account, Factory createClient, BenchClient** oldClient) {
+		BenchClient* newClient = nullptr;
+		std::string name = toLower(account);
+
+		*oldClient = nullptr;
+		uv_mutex_lock(&lock);
+		auto it = clients.find(accountId);
+		auto itName = clientsByName.find(name);
+		if(it != clients.end()) {
+			*oldClient = it->second;
+		} else if(itName != clientsByName.end()) {
+			*oldClient = itName->second;
+		} else {
+			newClient = createClient();
+			clients.insert(std::make_pair(accountId, newClient));
+			clientsByName.insert(std::make_pair(name, newClient));
+		}
+		uv_mutex_unlock(&lock);
+
+		return newClient;
+	}
+
+	BenchClient* find(const std::string& account) {
+		BenchClient* client = nullptr;
+
+		uv_mutex_lock(&lock);
+		auto it = clientsByName.find(toLower(account));
+		if(it != clientsByName.end())
+			client = it->second;
+		uv_mutex_unlock(&lock);
+
+		return client;
+	}
+
+	BenchClient* removeById(uint32_t accountId) {
+		BenchClient* client = nullptr;
+
+		uv_mutex_lock(&lock);
+		auto it = clients.find(accountId);
+		if(it != clients.end()) {
+			client = it->second;
+			clients.erase(it);
+			clientsByName.erase(toLower(client->account));
+		}
+		uv_mutex_unlock(&lock);
+
+		return client;
+	}
+
+private:
+	static std::string toLower(const std::string& str) {
+		std::string lcase = str;
+		for(size_t i = 0; i < lcase.size(); i++)
+			lcase[i] = AuthServer::AccountNameHash::toLower(lcase[i]);
+		return lcase;
+	}
+
+	uv_mutex_t lock;
+	std::unordered_map<uint32_t, BenchClient*> clients;
+	std::unordered_map<std::string, BenchClient*> clientsByName;
+};
+
+static const int ACCOUNTS_PER_THREAD = 2000;
+static const int ROUNDS = 50;
+
+template<class Index> struct ThreadContext {
+	Index* index;
+	int threadNumber;
+	uint64_t operations;
+};
+
+// Each thread logs in its own accounts, does the lookups done by GS login/logout events then logs them out
+template<class Index> static void benchThread(void* arg) {
+	ThreadContext<Index>* context = (ThreadContext<Index>*) arg;
+	std::vector<std::string> accounts(ACCOUNTS_PER_THREAD);
+	uint32_t firstAccountId = context->threadNumber * ACCOUNTS_PER_THREAD + 1;
+
+	for(int i = 0; i < ACCOUNTS_PER_THREAD; i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "Account%u", firstAccountId + i);
+		accounts[i] = name;
+	}
+
+	for(int round = 0; round < ROUNDS; round++) {
+		for(int i = 0; i < ACCOUNTS_PER_THREAD; i++) {
+			BenchClient* oldClient;
+			uint32_t accountId = firstAccountId + i;
+			const std::string& account = accounts[i];
+
+			context->index->tryAdd(accountId,
+			                       account,
+			                       [&]() {
+				                       BenchClient* client = new BenchClient;
+				                       client->accountId = accountId;
+				                       client->account = account;
+				                       return client;
+			                       },
+			                       &oldClient);
+		}
+		for(int i = 0; i < ACCOUNTS_PER_THREAD; i++) {
+			context->index->find(accounts[i]);
+			context->index->find(accounts[i]);
+		}
+		for(int i = 0; i < ACCOUNTS_PER_THREAD; i++)
+			delete context->index->removeById(firstAccountId + i);
+
+		context->operations += ACCOUNTS_PER_THREAD * 4;
+	}
+}
+
+template<class Index> static double runBench(int threadCount) {
+	Index index;
+	std::vector<uv_thread_t> threads(threadCount);
+	std::vector<ThreadContext<Index>> contexts(threadCount);
+	uint64_t operations = 0;
+
+	uint64_t start = uv_hrtime();
+	for(int i = 0; i < threadCount; i++) {
+		contexts[i].index = &index;
+		contexts[i].threadNumber = i;
+		contexts[i].operations = 0;
+		uv_thread_create(&threads[i], &benchThread<Index>, &contexts[i]);
+	}
+	for(int i = 0; i < threadCount; i++) {
+		uv_thread_join(&threads[i]);
+		operations += contexts[i].operations;
+	}
+	uint64_t duration = uv_hrtime() - start;
+
+	return operations * 1e9 / duration;
+}
+
+int main() {
+	static const int THREAD_COUNTS[] = {1, 2, 4, 8, 16};
+
+	printf("%d accounts per thread, %d rounds of login, 2 lookups by name, logout\n", ACCOUNTS_PER_THREAD, ROUNDS);
+	printf("threads   global lock (Mops/s)   ClientIndex (Mops/s)\n");
+
+	for(size_t i = 0; i < sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]); i++) {
+		double globalLock = runBench<GlobalLockIndex>(THREAD_COUNTS[i]);
+		double sharded = runBench<AuthServer::ClientIndex<BenchClient>>(THREAD_COUNTS[i]);
+
+		printf("%7d   %20.2f   %20.2f\n", THREAD_COUNTS[i], globalLock / 1e6, sharded / 1e6);
+	}
+
+	return 0;
+}
@@ -0,0 +1,161 @@
+#include "AuthServer/ClientIndex.h"
+#include <cstddef>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <unordered_map>
+#include <vector>
+
+// Memory used per connected client: the client record and both indexes (by account ID and by account name).
+// Before: record with a std::string account and a text IP, indexed by two std::unordered_map keyed by a copy of the
+// account ID and of the lower case account name.
+// After: compact record (same members as ClientData without the Object base) with an inline account name and a binary
+// IP, indexed by ClientIndex which only stores a pointer and a hash per entry.
+
+static size_t liveBytes = 0;
+
+void* operator new(size_t size) {
+	// Store the size before the returned block so delete knows it
+	size_t* block = (size_t*) malloc(size + sizeof(std::max_align_t));
+	if(!block)
+		throw std::bad_alloc();
+
+	*block = size;
+	liveBytes += size;
+	return (char*) block + sizeof(std::max_align_t);
+}
+
+void operator delete(void* ptr) noexcept {
+	if(!ptr)
+		return;
+
+	size_t* block = (size_t*) ((char*) ptr - sizeof(std::max_align_t));
+	liveBytes -= *block;
+	free(block);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	operator delete(ptr);
+}
+
+struct PreviousClient {
+	void* client;
+	void* server;
+	std::string account;
+	uint32_t accountId;
+	uint32_t age;
+	uint32_t eventCode;
+	uint64_t oneTimePassword;
+	uint32_t pcBang;
+	char ip[46];
+	time_t loginTime;
+	bool kickRequested;
+	bool admissionPending;
+	bool inGame;
+	void* prevInServer;
+	void* nextInServer;
+};
+
+struct CompactClient {
+	void* client;
+	void* server;
+	void* prevInServer;
+	void* nextInServer;
+	uint64_t oneTimePassword;
+	time_t loginTime;
+	uint32_t accountId;
+	uint32_t age;
+	uint32_t eventCode;
+	uint32_t pcBang;
+	AuthServer::AccountName account;
+	bool kickRequested : 1;
+	bool admissionPending : 1;
+	uint8_t ipAddress[16];
+	uint8_t ipFamily;
+	bool inGame : 1;
+};
+
+static std::string getAccount(uint32_t accountId) {
+	char account[AuthServer::AccountName::MAX_SIZE + 1];
+	snprintf(account, sizeof(account), "PlayerAccount%u", accountId);
+	return account;
+}
+
+static size_t measurePrevious(uint32_t clientCount) {
+	size_t bytesBefore = liveBytes;
+	std::unordered_map<uint32_t, PreviousClient*> clients;
+	std::unordered_map<std::string, PreviousClient*> clientsByName;
+
+	for(uint32_t i = 1; i <= clientCount; i++) {
+		PreviousClient* client = new PreviousClient();
+		client->account = getAccount(i);
+		client->accountId = i;
+		strcpy(client->ip, "192.168.100.200");
+
+		clients.insert(std::make_pair(i, client));
+		clientsByName.insert(std::make_pair("playeraccount" + std::to_string(i), client));
+	}
+
+	size_t bytes = liveBytes - bytesBefore;
+
+	for(auto& entry : clients)
+		delete entry.second;
+
+	return bytes;
+}
+
+static size_t measureCompact(uint32_t clientCount) {
+	size_t bytesBefore = liveBytes;
+	AuthServer::ClientIndex<CompactClient>* index = new AuthServer::ClientIndex<CompactClient>;
+
+	for(uint32_t i = 1; i <= clientCount; i++) {
+		CompactClient* oldClient;
+		std::string account = getAccount(i);
+
+		index->tryAdd(i,
+		              account,
+		              [&]() {
+			              CompactClient* client = new CompactClient();
+			              client->account.assign(account);
+			              client->accountId = i;
+			              client->ipFamily = 2;
+			              return client;
+		              },
+		              &oldClient);
+	}
+
+	size_t bytes = liveBytes - bytesBefore;
+
+	for(uint32_t i = 1; i <= clientCount; i++)
+		delete index->removeById(i);
+	delete index;
+
+	return bytes;
+}
+
+int main() {
+	static const uint32_t CLIENT_COUNTS[] = {100000, 1000000};
+
+	printf("record size: previous %u bytes, compact %u bytes\n",
+	       (unsigned int) sizeof(PreviousClient),
+	       (unsigned int) sizeof(CompactClient));
+	printf("   clients   previous (MB)  bytes/client   compact (MB)  bytes/client\n");
+
+	for(size_t i = 0; i < sizeof(CLIENT_COUNTS) / sizeof(CLIENT_COUNTS[0]); i++) {
+		uint32_t clientCount = CLIENT_COUNTS[i];
+		size_t previousBytes = measurePrevious(clientCount);
+		size_t compactBytes = measureCompact(clientCount);
+
+		printf("%10u   %13.1f  %12.1f   %12.1f  %12.1f\n",
+		       clientCount,
+		       previousBytes / 1048576.0,
+		       (double) previousBytes / clientCount,
+		       compactBytes / 1048576.0,
+		       (double) compactBytes / clientCount);
+	}
+
+	return 0;
+}
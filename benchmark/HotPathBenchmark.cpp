@@ -0,0 +1,331 @@
+#include "AuthServer/AccountName.h"
+#include "AuthServer/ClientData.h"
+#include "AuthServer/DB_Account.h"
+#include "AuthServer/GameData.h"
+#include "AuthServer/GameServerSession.h"
+#include "AuthServer/ServerListCache.h"
+#include "Cipher/DesPasswordCipher.h"
+#include "GlobalConfig.h"
+#include "LibRzuInit.h"
+#include "Packet/PacketBaseMessage.h"
+#include "UploadServer/IconServerSession.h"
+#include <chrono>
+#include <openssl/evp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// CPU cost of the per-login building blocks, one CSV line per case so results of two commits can be compared:
+//   benchmark,iterations,ns_per_op
+// Each case is repeated until it ran for at least the given time.
+// Usage: rzauth_bench_hotpath [filter] [min time per case in ms]
+// Only cases whose name contains filter are run.
+
+namespace {
+
+using namespace AuthServer;
+
+// Expose the protected steps of the account query preprocessing
+struct DB_AccountBench : public DB_Account {
+	using DB_Account::MAX_PASSWORD_SIZE;
+	using DB_Account::decryptPassword;
+	using DB_Account::isAccountNameValid;
+};
+
+// Requests are HTTP/1.0 so parseData doesn't answer them, there is no stream to write to.
+// This measures the request parsing only
+struct IconServerSessionBench : public UploadServer::IconServerSession {
+	using UploadServer::IconServerSession::parseData;
+};
+
+const char PASSWORD[] = "password1234";
+const unsigned char AES_KEY[32] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0xfe, 0xdc, 0xba,
+                                   0x98, 0x76, 0x54, 0x32, 0x10, 0x0f, 0x1e, 0x2d, 0x3c, 0x4b, 0x5a,
+                                   0x69, 0x78, 0x87, 0x96, 0xa5, 0xb4, 0xc3, 0xd2, 0xe1, 0xf0};
+const size_t ACCOUNT_BATCH_SIZE = 8;
+const size_t CLIENT_ROTATION = 1024;
+const int SERVER_COUNTS[] = {1, 10, 50, 100, 200};
+
+class HotPathBench {
+public:
+	HotPathBench(const char* filter, double minTime) : filter(filter), minTime(minTime), sink(0) {}
+
+	// function(iterations) runs iterations times the measured code, each iteration does opsPerIteration operations
+	template<class Function> void run(const std::string& name, size_t opsPerIteration, Function function) {
+		if(filter && name.find(filter) == std::string::npos)
+			return;
+
+		size_t iterations = 1;
+		double duration;
+
+		for(;;) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			function(iterations);
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+			duration = std::chrono::duration<double, std::nano>(end - start).count();
+			if(duration >= minTime || iterations >= ((size_t) 1 << 40))
+				break;
+
+			// Aim slightly above the min time to avoid a last run too short
+			double scale = duration > 0 ? minTime * 1.2 / duration : 100;
+			if(scale > 100)
+				scale = 100;
+			else if(scale < 2)
+				scale = 2;
+			iterations = (size_t)(iterations * scale);
+		}
+
+		printf("%s,%llu,%.1f\n",
+		       name.c_str(),
+		       (unsigned long long) (iterations * opsPerIteration),
+		       duration / (iterations * opsPerIteration));
+		fflush(stdout);
+	}
+
+	// Keep results alive so the compiler doesn't remove the measured code
+	void use(size_t value) { sink ^= value; }
+
+private:
+	const char* filter;
+	double minTime;  // in ns
+	volatile size_t sink;
+};
+
+DB_AccountData::Input createAccountInput(const std::string& account, DB_AccountData::EncryptMode cryptMode) {
+	DB_AccountData::Input input;
+	size_t passwordSize = sizeof(PASSWORD) - 1;
+
+	input.account = account;
+	strcpy(input.ip, "127.0.0.1");
+	input.cryptMode = cryptMode;
+	memcpy(input.aesKey, AES_KEY, sizeof(input.aesKey));
+	input.password[0] = '\0';
+
+	if(cryptMode == DB_AccountData::EM_AES) {
+		EVP_CIPHER_CTX* e_ctx = EVP_CIPHER_CTX_new();
+		int updateLength = 0;
+		int finalLength = 0;
+
+		input.cryptedPassword.resize(passwordSize + 16);
+		EVP_EncryptInit_ex(e_ctx, EVP_aes_128_cbc(), NULL, AES_KEY, AES_KEY + 16);
+		EVP_EncryptUpdate(
+		    e_ctx, &input.cryptedPassword[0], &updateLength, (const unsigned char*) PASSWORD, (int) passwordSize);
+		EVP_EncryptFinal_ex(e_ctx, &input.cryptedPassword[0] + updateLength, &finalLength);
+		input.cryptedPassword.resize(updateLength + finalLength);
+		EVP_CIPHER_CTX_free(e_ctx);
+	} else {
+		// Clients send the password in a fixed size field
+		input.cryptedPassword.assign(32, 0);
+		memcpy(&input.cryptedPassword[0], PASSWORD, passwordSize);
+		if(cryptMode == DB_AccountData::EM_DES)
+			DesPasswordCipher(CONFIG_GET()->auth.client.desKey.get().c_str())
+			    .encrypt(&input.cryptedPassword[0], (int) input.cryptedPassword.size());
+	}
+
+	return input;
+}
+
+void benchAccountPreprocessing(HotPathBench& bench) {
+	static const struct {
+		DB_AccountData::EncryptMode mode;
+		const char* name;
+	} modes[] = {{DB_AccountData::EM_None, "none"}, {DB_AccountData::EM_DES, "des"}, {DB_AccountData::EM_AES, "aes"}};
+
+	for(size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+		DB_AccountData::Input input = createAccountInput("Account1234", modes[i].mode);
+		char password[DB_AccountBench::MAX_PASSWORD_SIZE];
+
+		if(!DB_AccountBench::decryptPassword(&input, password) || strcmp(password, PASSWORD)) {
+			fprintf(stderr, "Wrong decrypted password with %s encryption\n", modes[i].name);
+			exit(1);
+		}
+
+		bench.run(std::string("DB_Account::decryptPassword/") + modes[i].name, 1, [&](size_t iterations) {
+			for(size_t n = 0; n < iterations; n++) {
+				DB_AccountBench::decryptPassword(&input, password);
+				bench.use(password[0]);
+			}
+		});
+	}
+
+	// Name check, decryption and salted MD5 of the password, with the single and batched version
+	DB_AccountData::Input input = createAccountInput("Account1234", DB_AccountData::EM_DES);
+	bench.run("DB_Account::preProcessInput/des", 1, [&](size_t iterations) {
+		for(size_t n = 0; n < iterations; n++) {
+			DB_Account::preProcessInput(&input);
+			bench.use(input.password[0]);
+		}
+	});
+
+	std::vector<DB_AccountData::Input> batchInputs;
+	DB_AccountData::Input* batchInputPtrs[ACCOUNT_BATCH_SIZE];
+	bool valid[ACCOUNT_BATCH_SIZE];
+
+	for(size_t i = 0; i < ACCOUNT_BATCH_SIZE; i++)
+		batchInputs.push_back(createAccountInput("Account" + std::to_string(i), DB_AccountData::EM_DES));
+	for(size_t i = 0; i < ACCOUNT_BATCH_SIZE; i++)
+		batchInputPtrs[i] = &batchInputs[i];
+
+	bench.run("DB_Account::preProcessInputs/des", ACCOUNT_BATCH_SIZE, [&](size_t iterations) {
+		for(size_t n = 0; n < iterations; n++) {
+			DB_Account::preProcessInputs(batchInputPtrs, valid, ACCOUNT_BATCH_SIZE);
+			bench.use(batchInputs[0].password[0]);
+		}
+	});
+}
+
+void benchAccountName(HotPathBench& bench) {
+	std::string validAccount = "Account1234";
+	std::string invalidAccount = "Account 1234";
+
+	bench.run("DB_Account::isAccountNameValid/valid", 1, [&](size_t iterations) {
+		for(size_t n = 0; n < iterations; n++)
+			bench.use(DB_AccountBench::isAccountNameValid(validAccount));
+	});
+
+	bench.run("DB_Account::isAccountNameValid/invalid", 1, [&](size_t iterations) {
+		for(size_t n = 0; n < iterations; n++)
+			bench.use(DB_AccountBench::isAccountNameValid(invalidAccount));
+	});
+
+	// Case insensitive hashing and comparison replaced the lower case copy of account names
+	AccountNameRef account(validAccount.c_str(), validAccount.size());
+	std::string otherCaseAccountStr = "aCCOUNT1234";
+	AccountNameRef otherCaseAccount(otherCaseAccountStr.c_str(), otherCaseAccountStr.size());
+
+	bench.run("AccountNameHash", 1, [&](size_t iterations) {
+		AccountNameHash hash;
+		for(size_t n = 0; n < iterations; n++)
+			bench.use(hash(account));
+	});
+
+	bench.run("AccountNameEqual", 1, [&](size_t iterations) {
+		AccountNameEqual equal;
+		for(size_t n = 0; n < iterations; n++)
+			bench.use(equal(account, otherCaseAccount));
+	});
+}
+
+void benchClientIndex(HotPathBench& bench) {
+	static const size_t CONNECTED_CLIENTS[] = {0, 100000};
+	std::vector<std::string> accounts;
+	std::vector<ClientData*> connectedClients;
+	char ip[INET6_ADDRSTRLEN] = "127.0.0.1";
+
+	for(size_t i = 0; i < CLIENT_ROTATION; i++)
+		accounts.push_back("Rotating" + std::to_string(i));
+
+	for(size_t i = 0; i < sizeof(CONNECTED_CLIENTS) / sizeof(CONNECTED_CLIENTS[0]); i++) {
+		// Other connected clients make the index larger
+		while(connectedClients.size() < CONNECTED_CLIENTS[i]) {
+			uint32_t accountId = (uint32_t)(CLIENT_ROTATION + connectedClients.size());
+			connectedClients.push_back(ClientData::tryAddClient(
+			    nullptr, "Connected" + std::to_string(accountId), accountId, 19, 0, 0, ip));
+		}
+
+		bench.run("ClientData::tryAddClient+removeClient/" + std::to_string(CONNECTED_CLIENTS[i]),
+		          1,
+		          [&](size_t iterations) {
+			          for(size_t n = 0; n < iterations; n++) {
+				          size_t index = n % CLIENT_ROTATION;
+				          ClientData* client =
+				              ClientData::tryAddClient(nullptr, accounts[index], (uint32_t) index, 19, 0, 0, ip);
+				          bench.use((size_t) client);
+				          ClientData::removeClient(client);
+			          }
+		          });
+	}
+
+	for(size_t i = 0; i < connectedClients.size(); i++)
+		ClientData::removeClient(connectedClients[i]);
+}
+
+void benchServerList(HotPathBench& bench) {
+	// Game servers are shown only when they are ready with a connection, they share the same session.
+	// Sessions are deleted by their socket once closed, this one is never connected and is kept until exit
+	GameServerSession* gameServerSession = new GameServerSession;
+	std::vector<GameData*> servers;
+
+	for(size_t i = 0; i < sizeof(SERVER_COUNTS) / sizeof(SERVER_COUNTS[0]); i++) {
+		while((int) servers.size() < SERVER_COUNTS[i]) {
+			uint16_t serverIdx = (uint16_t)(servers.size() + 1);
+			GameData* server = GameData::tryAdd(gameServerSession,
+			                                    serverIdx,
+			                                    "Server " + std::to_string(serverIdx),
+			                                    "127.0.0.1",
+			                                    4514 + serverIdx,
+			                                    "http://www.example.com/index_" + std::to_string(serverIdx) + ".html",
+			                                    false,
+			                                    nullptr);
+			server->setReady(true);
+			servers.push_back(server);
+		}
+
+		for(int epic2 = 0; epic2 <= 1; epic2++) {
+			std::string name = std::string("TS_AC_SERVER_LIST/") + (epic2 ? "epic2/" : "epic9/") +
+			                   std::to_string(SERVER_COUNTS[i]);
+
+			// The cache is dropped each time to measure the serialization
+			bench.run(name, 1, [&](size_t iterations) {
+				for(size_t n = 0; n < iterations; n++) {
+					ServerListCache::invalidate();
+					bench.use((size_t) ServerListCache::getServerList(epic2 != 0, 0xFFFF, 1)->size);
+				}
+			});
+		}
+	}
+
+	for(size_t i = 0; i < servers.size(); i++)
+		GameData::remove(servers[i]);
+	ServerListCache::invalidate();
+}
+
+void benchIconServer(HotPathBench& bench) {
+	// Never connected, kept until exit like the game server session
+	IconServerSessionBench* session = new IconServerSessionBench;
+	std::string requestStr = "GET /guild_icons/guild_1234567_icon.jpg HTTP/1.0\r\n"
+	                         "Host: 127.0.0.1:4617\r\n"
+	                         "User-Agent: Mozilla/4.0 (compatible)\r\n"
+	                         "Accept: */*\r\n"
+	                         "\r\n";
+	std::vector<char> request(requestStr.begin(), requestStr.end());
+	const char filename[] = "guild_1234567_icon.jpg";
+
+	bench.run("IconServerSession::parseData", 1, [&](size_t iterations) {
+		for(size_t n = 0; n < iterations; n++)
+			session->parseData(request);
+	});
+
+	bench.run("IconServerSession::checkName", 1, [&](size_t iterations) {
+		for(size_t n = 0; n < iterations; n++)
+			bench.use(UploadServer::IconServerSession::checkName(filename, sizeof(filename) - 1));
+	});
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+	const char* filter = argc > 1 && argv[1][0] ? argv[1] : nullptr;
+	double minTime = (argc > 2 ? strtod(argv[2], nullptr) : 200) * 1000000;
+
+	LibRzuScopedUse useLibRzu;
+	GlobalConfig::init();
+	DB_Account::init(CONFIG_GET()->auth.client.desKey);
+
+	HotPathBench bench(filter, minTime);
+
+	printf("benchmark,iterations,ns_per_op\n");
+
+	benchAccountPreprocessing(bench);
+	benchAccountName(bench);
+	benchClientIndex(bench);
+	benchServerList(bench);
+	benchIconServer(bench);
+
+	DB_Account::deinit();
+
+	return 0;
+}
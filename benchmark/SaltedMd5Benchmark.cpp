@@ -0,0 +1,155 @@
+#include "SaltedMd5.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <openssl/evp.h>
+
+// Compare password hashing as done before SaltedMd5 (salt copy + MD5 + hex by nibble) with SaltedMd5
+// Usage: rzauth_bench_saltedmd5 [iterations]
+
+static const char SALT[] = "2011";
+
+static void legacyToHex(const unsigned char md5[16], char hex[33]) {
+	for(int i = 0; i < 16; i++) {
+		unsigned char val = md5[i] >> 4;
+		if(val < 10)
+			hex[i * 2] = val + '0';
+		else
+			hex[i * 2] = val - 10 + 'a';
+
+		val = md5[i] & 0x0F;
+		if(val < 10)
+			hex[i * 2 + 1] = val + '0';
+		else
+			hex[i * 2 + 1] = val - 10 + 'a';
+	}
+	hex[32] = '\0';
+}
+
+static void legacyHash(const std::string& salt, const std::string& password, char hex[33]) {
+	unsigned char md5[16];
+	std::string buffer = salt;
+
+	buffer.append(password);
+	EVP_Digest(buffer.c_str(), buffer.size(), md5, nullptr, EVP_md5(), nullptr);
+	legacyToHex(md5, hex);
+}
+
+template<class Function> static double measure(const char* name, size_t count, Function function) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	function();
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	double nsPerHash = std::chrono::duration<double, std::nano>(end - start).count() / count;
+
+	printf("%-24s %8.1f ns/hash\n", name, nsPerHash);
+	return nsPerHash;
+}
+
+int main(int argc, char** argv) {
+	size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+	const size_t BATCH_SIZE = 8;
+	std::vector<std::string> passwords;
+	std::string salt = SALT;
+	SaltedMd5 hasher(salt);
+	volatile char sink = 0;
+
+	for(size_t i = 0; i < BATCH_SIZE; i++)
+		passwords.push_back("password" + std::to_string(i * 7919));
+
+	// Check results before measuring
+	const void* data[BATCH_SIZE];
+	size_t sizes[BATCH_SIZE];
+	unsigned char digests[BATCH_SIZE][SaltedMd5::DIGEST_SIZE];
+
+	for(size_t i = 0; i < BATCH_SIZE; i++) {
+		data[i] = passwords[i].c_str();
+		sizes[i] = passwords[i].size();
+	}
+
+	hasher.hashMultiple(data, sizes, digests, BATCH_SIZE);
+	for(size_t i = 0; i < BATCH_SIZE; i++) {
+		char expected[33];
+		char singleHex[SaltedMd5::HEX_SIZE];
+		char multipleHex[SaltedMd5::HEX_SIZE];
+		unsigned char singleDigest[SaltedMd5::DIGEST_SIZE];
+
+		legacyHash(salt, passwords[i], expected);
+		hasher.hash(passwords[i].c_str(), passwords[i].size(), singleDigest);
+		SaltedMd5::toHex(singleDigest, singleHex);
+		SaltedMd5::toHex(digests[i], multipleHex);
+
+		if(strcmp(expected, singleHex) || strcmp(expected, multipleHex)) {
+			printf("Hash mismatch for \"%s\": expected %s, got %s (single) and %s (multiple)\n",
+			       passwords[i].c_str(),
+			       expected,
+			       singleHex,
+			       multipleHex);
+			return 1;
+		}
+	}
+
+	printf("SIMD lanes: %s, %d iterations of %d passwords\n",
+	       SaltedMd5::hasSimdSupport() ? "SSE2" : "none",
+	       (int) iterations,
+	       (int) BATCH_SIZE);
+
+	size_t hashCount = iterations * BATCH_SIZE;
+
+	measure("legacy", hashCount, [&]() {
+		char hex[33];
+		for(size_t n = 0; n < iterations; n++) {
+			for(size_t i = 0; i < BATCH_SIZE; i++) {
+				legacyHash(salt, passwords[i], hex);
+				sink ^= hex[0];
+			}
+		}
+	});
+
+	measure("SaltedMd5::hash", hashCount, [&]() {
+		char hex[SaltedMd5::HEX_SIZE];
+		unsigned char digest[SaltedMd5::DIGEST_SIZE];
+		for(size_t n = 0; n < iterations; n++) {
+			for(size_t i = 0; i < BATCH_SIZE; i++) {
+				hasher.hash(data[i], sizes[i], digest);
+				SaltedMd5::toHex(digest, hex);
+				sink ^= hex[0];
+			}
+		}
+	});
+
+	measure("SaltedMd5::hashMultiple", hashCount, [&]() {
+		char hex[SaltedMd5::HEX_SIZE];
+		for(size_t n = 0; n < iterations; n++) {
+			hasher.hashMultiple(data, sizes, digests, BATCH_SIZE);
+			for(size_t i = 0; i < BATCH_SIZE; i++) {
+				SaltedMd5::toHex(digests[i], hex);
+				sink ^= hex[0];
+			}
+		}
+	});
+
+	measure("legacy hex", hashCount, [&]() {
+		char hex[33];
+		for(size_t n = 0; n < iterations; n++) {
+			for(size_t i = 0; i < BATCH_SIZE; i++) {
+				legacyToHex(digests[i], hex);
+				sink ^= hex[0];
+			}
+		}
+	});
+
+	measure("SaltedMd5::toHex", hashCount, [&]() {
+		char hex[SaltedMd5::HEX_SIZE];
+		for(size_t n = 0; n < iterations; n++) {
+			for(size_t i = 0; i < BATCH_SIZE; i++) {
+				SaltedMd5::toHex(digests[i], hex);
+				sink ^= hex[0];
+			}
+		}
+	});
+
+	return 0;
+}
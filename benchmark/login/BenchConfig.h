@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Config/ConfigInfo.h"
+
+namespace AuthServer {
+
+// Load generator settings, other settings (auth server address, executable, database) are the tests ones.
+// rzauth_bench.opt sets the ports of the auth server spawned with auth-bench.opt and its own database
+struct BenchConfig {
+	cval<int>& clients;
+	cval<int>& rsaKeys;
+	cval<int>& serverIdx;
+
+	BenchConfig()
+	    : clients(CFG_CREATE("bench.clients", 2000)),
+	      rsaKeys(CFG_CREATE("bench.rsakeys", 8)),
+	      serverIdx(CFG_CREATE("bench.serveridx", 20)) {}
+
+	static BenchConfig* get() {
+		static BenchConfig config;
+		return &config;
+	}
+};
+
+}  // namespace AuthServer
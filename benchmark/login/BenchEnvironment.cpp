@@ -0,0 +1,55 @@
+#include "BenchEnvironment.h"
+#include "AuthServer/GlobalConfig.h"
+#include "BenchConfig.h"
+#include "Database/DbConnection.h"
+#include "Database/DbConnectionPool.h"
+#include <stdio.h>
+
+int BenchEnvironment::getAccountCount() {
+	// Each login flow (DES and AES) uses its own accounts
+	return AuthServer::BenchConfig::get()->clients.get() * 2;
+}
+
+void BenchEnvironment::beforeTests() {
+	std::string authExec = AuthServer::CONFIG_GET()->authExecutable.get();
+	std::string connectionString = AuthServer::CONFIG_GET()->connectionString.get();
+	int accountCount = getAccountCount();
+
+	DbConnectionPool dbConnectionPool;
+	DbConnection* connection = dbConnectionPool.getConnection(connectionString.c_str());
+	ASSERT_NE(nullptr, connection);
+	ASSERT_NE(false, connection->execute("DROP TABLE IF EXISTS account;"));
+	ASSERT_NE(false,
+	          connection->execute("CREATE TABLE account (\r\n"
+	                              "        \"account_id\"    INTEGER NOT NULL,\r\n"
+	                              "        \"account\"       VARCHAR(61) NOT NULL,\r\n"
+	                              "        \"password\"      VARCHAR(61),\r\n"
+	                              "        \"last_login_server_idx\" INTEGER,\r\n"
+	                              "        \"server_idx_offset\"     INTEGER,\r\n"
+	                              "        \"security_no\"   VARCHAR(61),\r\n"
+	                              "        PRIMARY KEY(account_id)\r\n);"));
+	ASSERT_NE(false, connection->execute("CREATE INDEX account_name ON account (account);"));
+	connection->setAutoCommit(false);
+	for(int i = 0; i < accountCount; i++) {
+		char query[256];
+
+		snprintf(query,
+		         sizeof(query),
+		         "INSERT INTO account VALUES(%d,'bench%d','613b5247e3398350918cb622a3ec19e9',NULL,NULL,NULL);",
+		         i + 1,
+		         i);
+		ASSERT_NE(false, connection->execute(query));
+	}
+
+	connection->endTransaction(true);
+	connection->releaseAndClose();
+
+	std::string connectionStringArg = "/auth.db.connectionstring:";
+	connectionStringArg += connectionString;
+
+	spawnProcess(4520, authExec.c_str(), 2, "/configfile:./auth-bench.opt", connectionStringArg.c_str());
+}
+
+void BenchEnvironment::afterTests() {
+	stop(4521);
+}
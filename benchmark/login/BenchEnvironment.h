@@ -0,0 +1,13 @@
+#pragma once
+
+#include "TestEnvironment.h"
+
+// Fill the test database with bench accounts and spawn rzauth like the tests do
+class BenchEnvironment : public TestEnvironment {
+public:
+	virtual void beforeTests();
+	virtual void afterTests();
+
+	// Accounts are named bench<index>, their password is "admin"
+	static int getAccountCount();
+};
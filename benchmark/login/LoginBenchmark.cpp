@@ -0,0 +1,250 @@
+#include "AuthClient/Flat/TS_AC_SELECT_SERVER.h"
+#include "AuthClient/Flat/TS_CA_SELECT_SERVER.h"
+#include "AuthClient/Flat/TS_CA_SERVER_LIST.h"
+#include "AuthServer/ClientSession/Common.h"
+#include "AuthServer/GameServerSession/Common.h"
+#include "AuthServer/GlobalConfig.h"
+#include "BenchConfig.h"
+#include "FlatPackets/TS_AC_SERVER_LIST.h"
+#include "PacketEnums.h"
+#include "RzTest.h"
+#include "uv.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <memory>
+#include <openssl/rsa.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// End-to-end login throughput: all clients connect at once to the spawned rzauth and do a full login up to the game
+// server selection. Reports logins/s and latency percentiles of each phase:
+//  - handshake: TCP connection and, for AES, RSA key exchange
+//  - account: account packet sent -> auth result
+//  - server list: server list request -> server list
+//  - select: server selection -> one time password
+
+namespace AuthServer {
+
+namespace {
+
+enum Phase { P_Handshake, P_Account, P_ServerList, P_Select, P_Total, P_Count };
+const char* const PHASE_NAMES[P_Count] = {"handshake", "account", "server list", "select", "total"};
+
+struct BenchClient {
+	std::unique_ptr<TestConnectionChannel> channel;
+	std::string account;
+	RSA* rsaKey;
+	uint64_t startTime;
+	uint64_t phaseStartTime;
+	uint64_t durations[P_Count];
+	bool succeeded;
+};
+
+class LoginBench {
+public:
+	LoginBench(AuthMethod method, int firstAccount);
+	~LoginBench();
+
+	void run();
+
+private:
+	void addClientScenario(BenchClient* client);
+	void endPhase(BenchClient* client, Phase phase);
+	void onClientDone(BenchClient* client, bool succeeded);
+	void printResults(uint64_t duration);
+
+	AuthMethod method;
+	std::vector<std::unique_ptr<BenchClient>> clients;
+	std::vector<RSA*> rsaKeys;
+	TestConnectionChannel game;
+	int doneClients;
+	uint64_t startTime;
+	uint64_t endTime;
+};
+
+LoginBench::LoginBench(AuthMethod method, int firstAccount)
+    : method(method),
+      game(TestConnectionChannel::Client, CONFIG_GET()->game.ip, CONFIG_GET()->game.port, false),
+      doneClients(0),
+      startTime(0),
+      endTime(0) {
+	int clientCount = BenchConfig::get()->clients.get();
+
+	// RSA key generation is slow and not what is measured, clients share a few keys
+	if(method == AM_Aes) {
+		int keyCount = std::max(1, BenchConfig::get()->rsaKeys.get());
+		for(int i = 0; i < keyCount; i++)
+			rsaKeys.push_back(createRSAKey());
+	}
+
+	for(int i = 0; i < clientCount; i++) {
+		BenchClient* client = new BenchClient;
+
+		client->channel.reset(new TestConnectionChannel(
+		    TestConnectionChannel::Client, CONFIG_GET()->auth.ip, CONFIG_GET()->auth.port, true));
+		client->account = "bench" + std::to_string(firstAccount + i);
+		client->rsaKey = rsaKeys.empty() ? nullptr : rsaKeys[i % rsaKeys.size()];
+		client->startTime = 0;
+		client->phaseStartTime = 0;
+		client->succeeded = false;
+		for(int phase = 0; phase < P_Count; phase++)
+			client->durations[phase] = 0;
+
+		clients.emplace_back(client);
+		addClientScenario(client);
+	}
+}
+
+LoginBench::~LoginBench() {
+	for(size_t i = 0; i < rsaKeys.size(); i++)
+		freeRSAKey(rsaKeys[i]);
+}
+
+void LoginBench::run() {
+	RzTest test;
+	uint16_t serverIdx = (uint16_t) BenchConfig::get()->serverIdx.get();
+
+	// Clients need a game server to select, they all start once it is registered
+	addGameLoginScenario(game,
+	                     serverIdx,
+	                     "Bench server",
+	                     "http://www.example.com/index_bench.html",
+	                     false,
+	                     "127.0.0.1",
+	                     4514,
+	                     [this](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
+		                     startTime = uv_hrtime();
+		                     for(size_t i = 0; i < clients.size(); i++) {
+			                     clients[i]->startTime = clients[i]->phaseStartTime = uv_hrtime();
+			                     clients[i]->channel->start();
+		                     }
+	                     });
+	game.start();
+
+	test.addChannel(&game);
+	for(size_t i = 0; i < clients.size(); i++)
+		test.addChannel(clients[i]->channel.get());
+	test.run();
+
+	printResults(endTime - startTime);
+}
+
+void LoginBench::addClientScenario(BenchClient* client) {
+	TestConnectionChannel* channel = client->channel.get();
+
+	addClientLoginToServerListScenario(*channel,
+	                                   method,
+	                                   client->account.c_str(),
+	                                   "admin",
+	                                   nullptr,
+	                                   "201501120",
+	                                   client->rsaKey,
+	                                   [this, client](ClientLoginStep step) {
+		                                   endPhase(client, step == CLS_Handshake ? P_Handshake : P_Account);
+	                                   });
+
+	// A failed login is disconnected when asking the server list
+	channel->addCallback([this, client](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
+		if(event.type != TestConnectionChannel::Event::Packet || event.packet->id != TS_AC_SERVER_LIST::packetID) {
+			onClientDone(client, false);
+			return;
+		}
+		endPhase(client, P_ServerList);
+
+		TS_CA_SELECT_SERVER selectServerPacket;
+		TS_MESSAGE::initMessage(&selectServerPacket);
+		selectServerPacket.server_idx = (uint16_t) BenchConfig::get()->serverIdx.get();
+		channel->sendPacket(&selectServerPacket);
+	});
+
+	channel->addCallback([this, client](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
+		bool succeeded = false;
+
+		if(event.type == TestConnectionChannel::Event::Packet) {
+			if(method == AM_Aes && event.packet->id == TS_AC_SELECT_SERVER_RSA::packetID)
+				succeeded = AGET_PACKET(TS_AC_SELECT_SERVER_RSA)->result == TS_RESULT_SUCCESS;
+			else if(method == AM_Des && event.packet->id == TS_AC_SELECT_SERVER::packetID)
+				succeeded = AGET_PACKET(TS_AC_SELECT_SERVER)->result == TS_RESULT_SUCCESS;
+		}
+
+		if(succeeded) {
+			endPhase(client, P_Select);
+			client->durations[P_Total] = uv_hrtime() - client->startTime;
+		}
+		onClientDone(client, succeeded);
+	});
+}
+
+void LoginBench::endPhase(BenchClient* client, Phase phase) {
+	uint64_t now = uv_hrtime();
+
+	client->durations[phase] = now - client->phaseStartTime;
+	client->phaseStartTime = now;
+}
+
+void LoginBench::onClientDone(BenchClient* client, bool succeeded) {
+	EXPECT_TRUE(succeeded) << "Login failed for account " << client->account;
+
+	client->succeeded = succeeded;
+	client->channel->closeSession();
+
+	doneClients++;
+	if(doneClients == (int) clients.size()) {
+		endTime = uv_hrtime();
+		game.closeSession();
+	}
+}
+
+void LoginBench::printResults(uint64_t duration) {
+	std::vector<uint64_t> durations;
+	int succeededClients = 0;
+
+	for(size_t i = 0; i < clients.size(); i++) {
+		if(clients[i]->succeeded)
+			succeededClients++;
+	}
+
+	printf("%s: %d clients, %d logins in %.3f s: %.1f logins/s\n",
+	       method == AM_Aes ? "AES" : "DES",
+	       (int) clients.size(),
+	       succeededClients,
+	       duration / 1e9,
+	       duration ? succeededClients * 1e9 / duration : 0.0);
+	printf("phase         p50 (ms)   p99 (ms)  p999 (ms)   max (ms)\n");
+
+	for(int phase = 0; phase < P_Count; phase++) {
+		durations.clear();
+		for(size_t i = 0; i < clients.size(); i++) {
+			if(clients[i]->succeeded)
+				durations.push_back(clients[i]->durations[phase]);
+		}
+
+		if(durations.empty())
+			continue;
+
+		std::sort(durations.begin(), durations.end());
+		size_t last = durations.size() - 1;
+
+		printf("%-11s %10.3f %10.3f %10.3f %10.3f\n",
+		       PHASE_NAMES[phase],
+		       durations[last * 50 / 100] / 1e6,
+		       durations[last * 99 / 100] / 1e6,
+		       durations[last * 999 / 1000] / 1e6,
+		       durations[last] / 1e6);
+	}
+}
+
+}  // namespace
+
+TEST(LoginBenchmark, des) {
+	LoginBench bench(AM_Des, 0);
+	bench.run();
+}
+
+TEST(LoginBenchmark, aes) {
+	LoginBench bench(AM_Aes, BenchConfig::get()->clients.get());
+	bench.run();
+}
+
+}  // namespace AuthServer
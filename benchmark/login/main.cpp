@@ -0,0 +1,19 @@
+#include "AuthServer/GlobalConfig.h"
+#include "BenchConfig.h"
+#include "BenchEnvironment.h"
+#include "RunTests.h"
+#include "gtest/gtest.h"
+
+static void initConfigs() {
+	AuthServer::GlobalConfig::init();
+	AuthServer::BenchConfig::get();
+}
+
+int main(int argc, char** argv) {
+	TestRunner testRunner(argc, argv, &initConfigs);
+
+	// gtest takes ownership
+	::testing::AddGlobalTestEnvironment(new BenchEnvironment);
+
+	return testRunner.runTests();
+}
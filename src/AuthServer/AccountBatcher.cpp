@@ -0,0 +1,179 @@
+#include "AccountBatcher.h"
+#include "../GlobalConfig.h"
+#include "AccountCache.h"
+#include "ClientSession.h"
+#include "Console/ConsoleCommands.h"
+#include <string.h>
+
+namespace AuthServer {
+
+void AccountBatch::add(ClientSession* session, const DB_AccountData::Input& account) {
+	sessions.push_back(session);
+	input.accounts.push_back(account);
+	session->setAccountBatch(this);
+}
+
+void AccountBatch::cancel(ClientSession* session) {
+	for(size_t i = 0; i < sessions.size(); i++) {
+		if(sessions[i] == session)
+			sessions[i] = nullptr;
+	}
+}
+
+void AccountBatch::execute() {
+	executed = true;
+
+	if(!dbQuery.executeDbQuery<DB_AccountBatchData, DB_AccountBatch>(this, &AccountBatch::onQueryDone, input)) {
+		for(size_t i = 0; i < sessions.size(); i++)
+			sendResult(i, &input.accounts[i], nullptr);
+	}
+}
+
+void AccountBatch::onQueryDone(DB_AccountBatch* query) {
+	const DB_AccountBatchData::Input* queryInput = query->getInput();
+
+	for(size_t i = 0; i < sessions.size(); i++) {
+		const DB_AccountData::Input* account = &queryInput->accounts[i];
+		const DB_AccountBatchData::Output* row = nullptr;
+		DB_AccountBatchData::AccountState state =
+		    i < queryInput->states.size() ? queryInput->states[i] : DB_AccountBatchData::AS_Refused;
+
+		if(state == DB_AccountBatchData::AS_Cached) {
+			sendResult(i, account, &queryInput->cachedAccounts[i]);
+			continue;
+		} else if(state == DB_AccountBatchData::AS_Queried) {
+			row = query->findAccount(account->account);
+		}
+
+		// The batched query must filter on the password, a row without password would accept any password
+		if(!row || row->nullPassword) {
+			if(row)
+				Object::logStatic(LL_Warning,
+				                  "AuthServer::AccountBatch",
+				                  "Account \"%s\" has no password in the batched query result\n",
+				                  account->account.c_str());
+			sendResult(i, account, nullptr);
+			continue;
+		}
+
+		DB_AccountData::Output output;
+		output.account_id = row->account_id;
+		memcpy(output.password, row->password, sizeof(output.password));
+		output.nullPassword = row->nullPassword;
+		output.auth_ok = row->auth_ok;
+		output.age = row->age;
+		output.last_login_server_idx = row->last_login_server_idx;
+		output.event_code = row->event_code;
+		output.pcbang = row->pcbang;
+		output.server_idx_offset = row->server_idx_offset;
+		output.block = row->block;
+		DB_Account::checkPassword(account, &output);
+		AccountCache::get()->addAccount(account, &output);
+
+		sendResult(i, account, &output);
+	}
+}
+
+void AccountBatch::sendResult(size_t index, const DB_AccountData::Input* input, const DB_AccountData::Output* output) {
+	ClientSession* session = sessions[index];
+
+	if(session) {
+		sessions[index] = nullptr;
+		session->onAccountBatchResult(input, output);
+	}
+}
+
+void AccountBatcher::init() {
+	ConsoleCommands::get()->addCommand("db.batch.stats",
+	                                   "batchstats",
+	                                   0,
+	                                   0,
+	                                   &commandStats,
+	                                   "Show account query batching statistics",
+	                                   "db.batch.stats : show batched account queries count and batch sizes");
+}
+
+AccountBatcher* AccountBatcher::get() {
+	static AccountBatcher batcher;
+	return &batcher;
+}
+
+AccountBatcher::AccountBatcher() : batchCount(0), requestCount(0) {
+	for(size_t i = 0; i < sizeof(batchSizeCount) / sizeof(batchSizeCount[0]); i++)
+		batchSizeCount[i] = 0;
+}
+
+bool AccountBatcher::addRequest(ClientSession* session, const DB_AccountData::Input& account) {
+	if(CONFIG_GET()->auth.dbBatch.enable.get() == false)
+		return false;
+
+	int maxSize = CONFIG_GET()->auth.dbBatch.maxSize.get();
+	if(maxSize < 1)
+		maxSize = 1;
+	else if(maxSize > (int) DB_AccountBatchData::MAX_ACCOUNTS)
+		maxSize = DB_AccountBatchData::MAX_ACCOUNTS;
+
+	if(!pendingBatch) {
+		pendingBatch.reset(new AccountBatch);
+		flushTimer.start(this, &AccountBatcher::onFlushTimer, CONFIG_GET()->auth.dbBatch.window.get(), 0);
+	}
+
+	AccountBatch* batch = pendingBatch.get();
+	batch->add(session, account);
+	requestCount++;
+
+	if(batch->size() >= (size_t) maxSize)
+		flush();
+
+	return true;
+}
+
+void AccountBatcher::onFlushTimer() {
+	flush();
+}
+
+void AccountBatcher::flush() {
+	flushTimer.stop();
+
+	// Remove batches for which the result was already sent to sessions
+	for(auto it = runningBatches.begin(); it != runningBatches.end();) {
+		if((*it)->isDone())
+			it = runningBatches.erase(it);
+		else
+			++it;
+	}
+
+	if(!pendingBatch)
+		return;
+
+	size_t size = pendingBatch->size();
+	batchCount++;
+	if(size < sizeof(batchSizeCount) / sizeof(batchSizeCount[0]))
+		batchSizeCount[size]++;
+
+	runningBatches.push_back(std::move(pendingBatch));
+	runningBatches.back()->execute();
+}
+
+void AccountBatcher::stop() {
+	flushTimer.stop();
+	pendingBatch.reset();
+	runningBatches.clear();
+}
+
+void AccountBatcher::commandStats(IWritableConsole* console, const std::vector<std::string>& args) {
+	AccountBatcher* batcher = get();
+	uint64_t count = batcher->batchCount ? batcher->batchCount : 1;
+
+	console->writef("Account batches: %llu, requests: %llu, average size: %.2f, running: %d\r\n",
+	                (unsigned long long) batcher->batchCount,
+	                (unsigned long long) batcher->requestCount,
+	                (double) batcher->requestCount / count,
+	                (int) batcher->runningBatches.size());
+
+	for(size_t i = 1; i < sizeof(batcher->batchSizeCount) / sizeof(batcher->batchSizeCount[0]); i++) {
+		console->writef("Batches of size %d: %llu\r\n", (int) i, (unsigned long long) batcher->batchSizeCount[i]);
+	}
+}
+
+}  // namespace AuthServer
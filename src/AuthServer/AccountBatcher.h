@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Core/Object.h"
+#include "Core/Timer.h"
+#include "DB_AccountBatch.h"
+#include <list>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class IWritableConsole;
+
+namespace AuthServer {
+
+class ClientSession;
+
+// Logins resolved by one DB_AccountBatch query
+class AccountBatch {
+public:
+	AccountBatch() : executed(false) {}
+
+	void add(ClientSession* session, const DB_AccountData::Input& account);
+	size_t size() { return sessions.size(); }
+
+	// The session is gone, don't call it when the query is done
+	void cancel(ClientSession* session);
+
+	void execute();
+	bool isDone() { return executed && !dbQuery.inProgress(); }
+
+protected:
+	void onQueryDone(DB_AccountBatch* query);
+
+private:
+	void sendResult(size_t index, const DB_AccountData::Input* input, const DB_AccountData::Output* output);
+
+	std::vector<ClientSession*> sessions;
+	DB_AccountBatchData::Input input;
+	DbQueryJobRef dbQuery;
+	bool executed;
+};
+
+// Coalesce account lookups that arrive within a short window into one query (disabled by default).
+// Used only in the event loop thread
+class AccountBatcher : public Object {
+	DECLARE_CLASS(AuthServer::AccountBatcher)
+
+public:
+	static void init();
+	static AccountBatcher* get();
+
+	// Return false if batching is disabled, the account must be queried directly then.
+	// The session is notified of its batch with ClientSession::setAccountBatch
+	bool addRequest(ClientSession* session, const DB_AccountData::Input& account);
+
+	void stop();
+
+protected:
+	static void commandStats(IWritableConsole* console, const std::vector<std::string>& args);
+
+private:
+	AccountBatcher();
+
+	void onFlushTimer();
+	void flush();
+
+	std::unique_ptr<AccountBatch> pendingBatch;
+	std::list<std::unique_ptr<AccountBatch>> runningBatches;
+	Timer<AccountBatcher> flushTimer;
+
+	uint64_t batchCount;
+	uint64_t requestCount;
+	uint64_t batchSizeCount[DB_AccountBatchData::MAX_ACCOUNTS + 1];
+};
+
+}  // namespace AuthServer
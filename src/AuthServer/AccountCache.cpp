@@ -0,0 +1,203 @@
+#include "AccountCache.h"
+#include "../GlobalConfig.h"
+#include "Console/ConsoleCommands.h"
+#include <ctype.h>
+#include <string.h>
+
+namespace AuthServer {
+
+void AccountCache::init() {
+	ConsoleCommands::get()->addCommand("account.cache.stats",
+	                                   "accountcache",
+	                                   0,
+	                                   0,
+	                                   &commandStats,
+	                                   "Show account cache statistics",
+	                                   "account.cache.stats : show cached accounts count, hits and misses");
+	ConsoleCommands::get()->addCommand(
+	    "account.cache.invalidate",
+	    "invalidateaccount",
+	    0,
+	    1,
+	    &commandInvalidate,
+	    "Remove an account from the account cache",
+	    "account.cache.invalidate [account] : remove the account from the cache, or all accounts if none is given");
+}
+
+AccountCache* AccountCache::get() {
+	static AccountCache cache;
+	return &cache;
+}
+
+AccountCache::AccountCache() : hits(0), misses(0), invalidations(0) {
+	uv_mutex_init(&lock);
+}
+
+AccountCache::~AccountCache() {
+	uv_mutex_destroy(&lock);
+}
+
+std::string AccountCache::getKey(const std::string& account) {
+	std::string key(account);
+
+	// Account names are case insensitive in the database
+	for(size_t i = 0; i < key.size(); i++)
+		key[i] = tolower((unsigned char) key[i]);
+
+	return key;
+}
+
+bool AccountCache::getAccount(const DB_AccountData::Input* input, DB_AccountData::Output* output) {
+	if(CONFIG_GET()->auth.dbCache.enable.get() == false)
+		return false;
+
+	std::string key = getKey(input->account);
+	uint64_t now = uv_hrtime();
+	bool found = false;
+
+	uv_mutex_lock(&lock);
+	auto it = entriesByAccount.find(key);
+	if(it != entriesByAccount.end()) {
+		Entry& entry = *it->second;
+
+		if(entry.expireTime <= now) {
+			entries.erase(it->second);
+			entriesByAccount.erase(it);
+		} else if(!strcmp(entry.password, input->password)) {
+			entries.splice(entries.begin(), entries, it->second);
+			*output = entry.output;
+			found = true;
+		}
+	}
+
+	if(found)
+		hits++;
+	else
+		misses++;
+	uv_mutex_unlock(&lock);
+
+	return found;
+}
+
+void AccountCache::addAccount(const DB_AccountData::Input* input, const DB_AccountData::Output* output) {
+	if(CONFIG_GET()->auth.dbCache.enable.get() == false || output->ok == false)
+		return;
+
+	int maxSize = CONFIG_GET()->auth.dbCache.maxSize.get();
+	if(maxSize <= 0)
+		return;
+
+	std::string key = getKey(input->account);
+	uint64_t expireTime = uv_hrtime() + (uint64_t) CONFIG_GET()->auth.dbCache.ttl.get() * 1000000000;
+
+	uv_mutex_lock(&lock);
+	auto it = entriesByAccount.find(key);
+	if(it != entriesByAccount.end()) {
+		entries.splice(entries.begin(), entries, it->second);
+	} else {
+		entries.push_front(Entry());
+		entries.front().key = key;
+		entriesByAccount[key] = entries.begin();
+	}
+
+	Entry& entry = entries.front();
+	memcpy(entry.password, input->password, sizeof(entry.password));
+	entry.output = *output;
+	entry.expireTime = expireTime;
+
+	while(entries.size() > (size_t) maxSize) {
+		entriesByAccount.erase(entries.back().key);
+		entries.pop_back();
+	}
+	uv_mutex_unlock(&lock);
+}
+
+void AccountCache::updateLastServerIdx(const std::string& account, uint16_t lastLoginServerIdx) {
+	std::string key = getKey(account);
+
+	uv_mutex_lock(&lock);
+	auto it = entriesByAccount.find(key);
+	if(it != entriesByAccount.end())
+		it->second->output.last_login_server_idx = lastLoginServerIdx;
+	uv_mutex_unlock(&lock);
+}
+
+size_t AccountCache::invalidateAccount(const std::string& account) {
+	std::string key = getKey(account);
+	size_t count = 0;
+
+	uv_mutex_lock(&lock);
+	auto it = entriesByAccount.find(key);
+	if(it != entriesByAccount.end()) {
+		entries.erase(it->second);
+		entriesByAccount.erase(it);
+		count = 1;
+	}
+	invalidations += count;
+	uv_mutex_unlock(&lock);
+
+	return count;
+}
+
+size_t AccountCache::invalidateAccountId(uint32_t accountId) {
+	size_t count = 0;
+
+	uv_mutex_lock(&lock);
+	for(auto it = entries.begin(); it != entries.end();) {
+		if(it->output.account_id == accountId) {
+			entriesByAccount.erase(it->key);
+			it = entries.erase(it);
+			count++;
+		} else {
+			++it;
+		}
+	}
+	invalidations += count;
+	uv_mutex_unlock(&lock);
+
+	return count;
+}
+
+size_t AccountCache::clear() {
+	size_t count;
+
+	uv_mutex_lock(&lock);
+	count = entries.size();
+	entriesByAccount.clear();
+	entries.clear();
+	invalidations += count;
+	uv_mutex_unlock(&lock);
+
+	return count;
+}
+
+void AccountCache::commandStats(IWritableConsole* console, const std::vector<std::string>& args) {
+	AccountCache* cache = get();
+
+	uv_mutex_lock(&cache->lock);
+	size_t size = cache->entries.size();
+	uint64_t hits = cache->hits;
+	uint64_t misses = cache->misses;
+	uint64_t invalidations = cache->invalidations;
+	uv_mutex_unlock(&cache->lock);
+
+	console->writef("Account cache: %s, accounts: %d, hits: %llu, misses: %llu, invalidations: %llu\r\n",
+	                CONFIG_GET()->auth.dbCache.enable.get() ? "enabled" : "disabled",
+	                (int) size,
+	                (unsigned long long) hits,
+	                (unsigned long long) misses,
+	                (unsigned long long) invalidations);
+}
+
+void AccountCache::commandInvalidate(IWritableConsole* console, const std::vector<std::string>& args) {
+	size_t count;
+
+	if(args.empty())
+		count = get()->clear();
+	else
+		count = get()->invalidateAccount(args[0]);
+
+	console->writef("Removed %d accounts from the account cache\r\n", (int) count);
+}
+
+}  // namespace AuthServer
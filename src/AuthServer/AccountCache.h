@@ -0,0 +1,63 @@
+#pragma once
+
+#include "DB_Account.h"
+#include "uv.h"
+#include <list>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class IWritableConsole;
+
+namespace AuthServer {
+
+// Cache of account rows of successful logins, so relogs don't need a DB query (disabled by default).
+// Entries are keyed by account name and only used if the salted password hash match.
+// Thread safe, used from DB threads.
+class AccountCache {
+public:
+	static void init();
+	static AccountCache* get();
+
+	// Return true and fill output if the account is cached with the same password
+	bool getAccount(const DB_AccountData::Input* input, DB_AccountData::Output* output);
+	// Add the account if the login succeeded
+	void addAccount(const DB_AccountData::Input* input, const DB_AccountData::Output* output);
+
+	void updateLastServerIdx(const std::string& account, uint16_t lastLoginServerIdx);
+
+	// Return the number of removed entries
+	size_t invalidateAccount(const std::string& account);
+	size_t invalidateAccountId(uint32_t accountId);
+	size_t clear();
+
+protected:
+	static void commandStats(IWritableConsole* console, const std::vector<std::string>& args);
+	static void commandInvalidate(IWritableConsole* console, const std::vector<std::string>& args);
+
+private:
+	AccountCache();
+	~AccountCache();
+
+	static std::string getKey(const std::string& account);
+
+	struct Entry {
+		std::string key;
+		char password[33];
+		DB_AccountData::Output output;
+		uint64_t expireTime;
+	};
+	typedef std::list<Entry> EntryList;
+
+	uv_mutex_t lock;
+	// Most recently used first
+	EntryList entries;
+	std::unordered_map<std::string, EntryList::iterator> entriesByAccount;
+
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t invalidations;
+};
+
+}  // namespace AuthServer
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+namespace AuthServer {
+
+// Account name stored inline, used as a hash key without any allocation.
+// Account names are compared and hashed case insensitively (ASCII only) with AccountNameHash and AccountNameEqual.
+struct AccountName {
+	// Account fields in packets are 61 bytes with the null terminator
+	static const size_t MAX_SIZE = 60;
+
+	char name[MAX_SIZE + 1];
+	uint8_t size;
+
+	AccountName() : size(0) { name[0] = '\0'; }
+
+	// Return false if account is longer than MAX_SIZE, the name is then left empty
+	bool assign(const char* account, size_t accountSize) {
+		if(accountSize > MAX_SIZE) {
+			size = 0;
+			name[0] = '\0';
+			return false;
+		}
+
+		memcpy(name, account, accountSize);
+		name[accountSize] = '\0';
+		size = (uint8_t) accountSize;
+		return true;
+	}
+	bool assign(const std::string& account) { return assign(account.c_str(), account.size()); }
+
+	const char* c_str() const { return name; }
+};
+
+// Lookup key, so std::string or AccountName can be searched without copying them
+struct AccountNameRef {
+	const char* data;
+	size_t size;
+
+	AccountNameRef(const char* data, size_t size) : data(data), size(size) {}
+	AccountNameRef(const std::string& account) : data(account.c_str()), size(account.size()) {}
+	AccountNameRef(const AccountName& account) : data(account.name), size(account.size) {}
+};
+
+struct AccountNameHash {
+	static char toLower(char c) { return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c; }
+
+	// Load up to 8 characters (missing ones are 0) and convert them to lower case all at once
+	static uint64_t loadLowerWord(const char* data, size_t size) {
+		const uint64_t HIGH_BITS = 0x8080808080808080ULL;
+		uint64_t word = 0;
+
+		if(size >= 8) {
+			memcpy(&word, data, 8);
+		} else {
+			for(size_t i = 0; i < size; i++)
+				word |= (uint64_t)(unsigned char) data[i] << (i * 8);
+		}
+
+		// High bit of each byte set for 'A' to 'Z', non ASCII bytes are left as is
+		uint64_t lowBits = word & ~HIGH_BITS;
+		uint64_t aboveA = lowBits + 0x3F3F3F3F3F3F3F3FULL;  // 0x80 - 'A'
+		uint64_t aboveZ = lowBits + 0x2525252525252525ULL;  // 0x80 - 'Z' - 1
+		uint64_t upperCase = aboveA & ~aboveZ & ~word & HIGH_BITS;
+
+		return word | (upperCase >> 2);
+	}
+
+	size_t operator()(AccountNameRef account) const {
+		uint64_t hash = account.size * 0x9E3779B97F4A7C15ULL;
+
+		for(size_t i = 0; i < account.size; i += 8) {
+			hash ^= loadLowerWord(account.data + i, account.size - i);
+			hash *= 0xFF51AFD7ED558CCDULL;
+			hash ^= hash >> 29;
+		}
+
+		return (size_t) (hash ^ (hash >> 32));
+	}
+};
+
+struct AccountNameEqual {
+	bool operator()(AccountNameRef a, AccountNameRef b) const {
+		if(a.size != b.size)
+			return false;
+
+		for(size_t i = 0; i < a.size; i += 8) {
+			if(AccountNameHash::loadLowerWord(a.data + i, a.size - i) !=
+			   AccountNameHash::loadLowerWord(b.data + i, b.size - i))
+				return false;
+		}
+
+		return true;
+	}
+};
+
+}  // namespace AuthServer
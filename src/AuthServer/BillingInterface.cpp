@@ -1,4 +1,5 @@
 #include "BillingInterface.h"
+#include "AccountCache.h"
 #include "ClientData.h"
 #include "GameData.h"
 #include <stdlib.h>
@@ -6,6 +7,9 @@
 namespace AuthServer {
 
 static const char MSG_CONNECTED[] = "Connected to billing telnet server\r\n";
+static MemoryCounter billingInterfaceMemory("AuthServer::BillingInterface");
+
+BillingInterface::BillingInterface() : memoryUsage(billingInterfaceMemory, sizeof(BillingInterface)) {}
 
 EventChain<SocketSession> BillingInterface::onConnected() {
 	write(MSG_CONNECTED, sizeof(MSG_CONNECTED));
@@ -23,10 +27,19 @@ void BillingInterface::onCommand(const std::vector<std::string>& args) {
 		} else {
 			log(LL_Debug, "Command billing_notify: expected 2 arguments, got %d\n", (int) args.size() - 1);
 		}
+	} else if(args[0] == "account_invalidate") {
+		if(args.size() >= 2) {
+			uint32_t accountId = atoi(args[1].c_str());
+			size_t count = AccountCache::get()->invalidateAccountId(accountId);
+			log(LL_Debug, "Account cache invalidated for account id %d (%d entries)\n", accountId, (int) count);
+		} else {
+			log(LL_Debug, "Command account_invalidate: expected 1 argument, got %d\n", (int) args.size() - 1);
+		}
 	} else {
 		log(LL_Debug, "Unknown billing command: %s\n", args[0].c_str());
 		log(LL_Debug, "Usage: billing_notify blank <account_id>\n");
 		log(LL_Debug, "       billing_notify supply <account_id>\n");
+		log(LL_Debug, "       account_invalidate <account_id>\n");
 	}
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../MemoryCounter.h"
 #include "Core/Object.h"
 #include "NetSession/TelnetSession.h"
 #include <string>
@@ -8,11 +9,17 @@ namespace AuthServer {
 
 class BillingInterface : public TelnetSession {
 	DECLARE_CLASS(AuthServer::BillingInterface)
+public:
+	BillingInterface();
+
 protected:
 	EventChain<SocketSession> onConnected();
 	void onCommand(const std::vector<std::string>& args);
 
 	void billingNotice(const std::string& cmd, const std::string& accountIdStr);
+
+private:
+	TrackedMemory memoryUsage;
 };
 
 }  // namespace AuthServer
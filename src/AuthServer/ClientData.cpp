@@ -1,40 +1,52 @@
 #include "ClientData.h"
+#include "../MemoryCounter.h"
+#include "../ObjectPool.h"
 #include "ClientSession.h"
 #include "GameData.h"
-#include "uv.h"
-#include <algorithm>
+#include <string.h>
 #include <time.h>
 
 namespace AuthServer {
 
-uv_mutex_t ClientData::mapLock = initializeLock();
-std::unordered_map<uint32_t, ClientData*> ClientData::connectedClients;
-std::unordered_map<std::string, ClientData*> ClientData::connectedClientsByName;
-
-uv_mutex_t ClientData::initializeLock() {
-	uv_mutex_init(&mapLock);
-	return mapLock;
-}
+ClientIndex<ClientData> ClientData::connectedClients;
+static ObjectPool<ClientData> clientDataPool("AuthServer::ClientData");
+static MemoryCounter clientDataMemory("AuthServer::ClientData");
 
 ClientData::ClientData(ClientSession* clientInfo)
-    : accountId(0), kickRequested(false), client(clientInfo), server(nullptr), inGame(false) {}
+    : oneTimePassword(0),
+      loginTime(0),
+      accountId(0),
+      age(0),
+      eventCode(0),
+      pcBang(0),
+      kickRequested(false),
+      admissionPending(false),
+      client(clientInfo),
+      server(nullptr),
+      prevInServer(nullptr),
+      nextInServer(nullptr),
+      ipFamily(0),
+      inGame(false) {}
 
 ClientData::~ClientData() {
 	if(getGameServer() && inGame)
 		getGameServer()->decPlayerCount();
+	if(getGameServer()) {
+		getGameServer()->releaseAdmission(this);
+		getGameServer()->removeClient(this);
+	}
 }
 
-static int toLowerChar(int c) {
-	if(c >= 'A' && c <= 'Z')
-		c += 'a' - 'A';
-
-	return c;
+void* ClientData::operator new(size_t size) {
+	void* ptr = ObjectPool<ClientData>::allocateObject(clientDataPool, size);
+	clientDataMemory.add(size);
+	return ptr;
 }
 
-std::string ClientData::toLower(const std::string& str) {
-	std::string lcase = str;
-	std::transform(lcase.begin(), lcase.end(), lcase.begin(), toLowerChar);
-	return lcase;
+void ClientData::operator delete(void* ptr, size_t size) {
+	if(ptr)
+		clientDataMemory.remove(size);
+	ObjectPool<ClientData>::deallocateObject(clientDataPool, ptr, size);
 }
 
 ClientData* ClientData::tryAddClient(ClientSession* clientInfo,
@@ -45,159 +57,135 @@ ClientData* ClientData::tryAddClient(ClientSession* clientInfo,
                                      uint32_t pcBang,
                                      const char ip[INET6_ADDRSTRLEN],
                                      ClientData** oldClientPtr) {
-	std::pair<std::unordered_map<uint32_t, ClientData*>::iterator, bool> result;
-	std::pair<std::unordered_map<std::string, ClientData*>::iterator, bool> resultForName;
-	ClientData* newClient;
-
-	if(oldClientPtr)
-		*oldClientPtr = nullptr;
-
-	uv_mutex_lock(&mapLock);
-
-	newClient = new ClientData(clientInfo);
-	result = connectedClients.insert(std::pair<uint32_t, ClientData*>(accoundId, newClient));
-	if(result.second == false) {
-		ClientData* oldClient = result.first->second;
-		delete newClient;
-		newClient = nullptr;
-
-		if(oldClientPtr)
-			*oldClientPtr = oldClient;
-	} else {
-		newClient->account = account;
-		newClient->accountId = accoundId;
-		newClient->age = age;
-		newClient->eventCode = event_code;
-		newClient->pcBang = pcBang;
-		memcpy(newClient->ip, ip, INET6_ADDRSTRLEN);
-		resultForName = connectedClientsByName.insert(std::pair<std::string, ClientData*>(toLower(account), newClient));
-		if(resultForName.second == false) {
-			newClient->log(LL_Error, "Duplicated account name with different ID: %s\n", account.c_str());
-			if(oldClientPtr)
-				*oldClientPtr = resultForName.first->second;
-			connectedClients.erase(result.first);
-			delete newClient;
-			newClient = nullptr;
-		}
+	auto createClient = [&]() {
+		ClientData* client = new ClientData(clientInfo);
+		client->account.assign(account);
+		client->accountId = accoundId;
+		client->age = age;
+		client->eventCode = event_code;
+		client->pcBang = pcBang;
+		client->setIp(ip);
+		return client;
+	};
+	ClientData* oldClient;
+	ClientData* newClient = connectedClients.tryAdd(accoundId, account, createClient, &oldClient);
+
+	// Clients of a removed game server are not connected anymore, don't wait for GameDataTeardown to remove them
+	if(oldClient && oldClient->getGameServer() && oldClient->getGameServer()->isRemoved()) {
+		removeClient(oldClient);
+		newClient = connectedClients.tryAdd(accoundId, account, createClient, &oldClient);
 	}
 
-	uv_mutex_unlock(&mapLock);
+	if(oldClient && oldClient->accountId != accoundId)
+		logStatic(LL_Error,
+		          ClientData::getStaticClassName(),
+		          "Duplicated account name with different ID: %s\n",
+		          account.c_str());
+	else if(!newClient && !oldClient)
+		logStatic(LL_Error,
+		          ClientData::getStaticClassName(),
+		          "Account name too long: %s (max %d characters)\n",
+		          account.c_str(),
+		          (int) AccountName::MAX_SIZE);
+
+	if(oldClientPtr)
+		*oldClientPtr = oldClient;
 
 	return newClient;
 }
 
 bool ClientData::removeClient(const std::string& account) {
-	bool ret = false;
-	std::unordered_map<std::string, ClientData*>::iterator it;
-
-	uv_mutex_lock(&mapLock);
-	it = connectedClientsByName.find(toLower(account));
-	if(it != connectedClientsByName.end()) {
-		ClientData* clientData = it->second;
-		connectedClientsByName.erase(it);
-		connectedClients.erase(clientData->accountId);
-		delete clientData;
-		ret = true;
-	} else {
+	ClientData* clientData = connectedClients.remove(account);
+
+	if(!clientData) {
 		logStatic(LL_Error,
 		          ClientData::getStaticClassName(),
 		          "Trying to remove a not connected account : %s\n",
 		          account.c_str());
+		return false;
 	}
-	uv_mutex_unlock(&mapLock);
 
-	return ret;
+	delete clientData;
+	return true;
 }
 
 bool ClientData::removeClient(uint32_t accountId) {
-	bool ret = false;
-	std::unordered_map<uint32_t, ClientData*>::iterator it;
-
-	uv_mutex_lock(&mapLock);
-	it = connectedClients.find(accountId);
-	if(it != connectedClients.end()) {
-		ClientData* clientData = it->second;
-		connectedClients.erase(it);
-		connectedClientsByName.erase(toLower(clientData->account));
-		delete clientData;
-		ret = true;
-	} else {
+	ClientData* clientData = connectedClients.removeById(accountId);
+
+	if(!clientData) {
 		logStatic(
 		    LL_Error, ClientData::getStaticClassName(), "Trying to remove a not connected account : %d\n", accountId);
+		return false;
 	}
-	uv_mutex_unlock(&mapLock);
 
-	return ret;
+	delete clientData;
+	return true;
 }
 
 bool ClientData::removeClient(ClientData* clientData) {
 	return removeClient(clientData->accountId);
 }
 
+void ClientData::setIp(const char ip[INET6_ADDRSTRLEN]) {
+	char ipText[INET6_ADDRSTRLEN];
+
+	// ip might not be null terminated when coming from a packet
+	memcpy(ipText, ip, INET6_ADDRSTRLEN);
+	ipText[INET6_ADDRSTRLEN - 1] = '\0';
+
+	if(uv_inet_pton(AF_INET, ipText, ipAddress) == 0)
+		ipFamily = AF_INET;
+	else if(uv_inet_pton(AF_INET6, ipText, ipAddress) == 0)
+		ipFamily = AF_INET6;
+	else
+		ipFamily = 0;
+}
+
+void ClientData::getIp(char ip[INET6_ADDRSTRLEN]) const {
+	if(ipFamily == 0 || uv_inet_ntop(ipFamily, ipAddress, ip, INET6_ADDRSTRLEN) != 0)
+		ip[0] = '\0';
+}
+
 void ClientData::switchClientToServer(GameData* server, uint64_t oneTimePassword) {
+	if(this->server)
+		this->server->removeClient(this);
+
 	this->oneTimePassword = oneTimePassword;
 	this->client = nullptr;
 	this->server = server;
+	server->addClient(this);
 }
 
 void ClientData::connectedToGame() {
-	if(!getGameServer())
+	if(!getGameServer()) {
 		log(LL_Error, "Connected to unknown game server ! Code logic error\n");
-	else
+	} else {
+		getGameServer()->releaseAdmission(this);
 		getGameServer()->incPlayerCount();
+	}
 	inGame = true;
 	loginTime = time(nullptr);
 }
 
 ClientData* ClientData::getClient(const std::string& account) {
-	ClientData* foundClient;
-	std::unordered_map<std::string, ClientData*>::const_iterator it;
-
-	uv_mutex_lock(&mapLock);
-
-	it = connectedClientsByName.find(toLower(account));
-	if(it != connectedClientsByName.cend())
-		foundClient = it->second;
-	else
-		foundClient = nullptr;
-
-	uv_mutex_unlock(&mapLock);
-
-	return foundClient;
+	return connectedClients.find(account);
 }
 
 ClientData* ClientData::getClientById(uint32_t accountId) {
-	ClientData* foundClient;
-	std::unordered_map<uint32_t, ClientData*>::const_iterator it;
-
-	uv_mutex_lock(&mapLock);
-
-	it = connectedClients.find(accountId);
-	if(it != connectedClients.cend())
-		foundClient = it->second;
-	else
-		foundClient = nullptr;
-
-	uv_mutex_unlock(&mapLock);
-
-	return foundClient;
+	return connectedClients.findById(accountId);
 }
 
 void ClientData::removeServer(GameData* server) {
-	std::unordered_map<uint32_t, ClientData*>::const_iterator it, itEnd;
-
-	uv_mutex_lock(&mapLock);
-	for(it = connectedClients.begin(), itEnd = connectedClients.end(); it != itEnd;) {
-		ClientData* client = it->second;
-		if(client->getGameServer() == server) {
-			connectedClientsByName.erase(toLower(client->account));
-			it = connectedClients.erase(it);
-			delete client;
-		} else {
-			++it;
-		}
-	}
-	uv_mutex_unlock(&mapLock);
+	while(server->getFirstClient())
+		removeServerClient(server);
+}
+
+void ClientData::removeServerClient(GameData* server) {
+	ClientData* client = server->getFirstClient();
+
+	// Should not happen as clients are in the index until deleted, but never loop forever on the same client
+	if(!removeClient(client))
+		server->removeClient(client);
 }
 
 }  // namespace AuthServer
@@ -1,17 +1,17 @@
 #pragma once
 
+#include "ClientIndex.h"
 #include "Core/Object.h"
 #include "Stream/StreamAddress.h"
-#include "uv.h"
 #include <stdint.h>
 #include <string>
-#include <unordered_map>
 
 namespace AuthServer {
 
 class ClientSession;
 class GameData;
 
+// Members are packed to limit padding (binary IP, inline account, bit flags), there can be a lot of instances
 class ClientData : public Object {
 	DECLARE_CLASS(AuthServer::ClientData)
 
@@ -19,21 +19,26 @@ public:
 	ClientData(ClientSession* clientInfo);
 	void switchClientToServer(GameData* server, uint64_t oneTimePassword);
 
-	std::string account;
+	// Binary IP address, getIp converts it back to text
+	void setIp(const char ip[INET6_ADDRSTRLEN]);
+	void getIp(char ip[INET6_ADDRSTRLEN]) const;
+
+	uint64_t oneTimePassword;
+	time_t loginTime;
 	uint32_t accountId;
 	uint32_t age;
 	uint32_t eventCode;
-	uint64_t oneTimePassword;
 	uint32_t pcBang;
-	char ip[INET6_ADDRSTRLEN];
-	time_t loginTime;
-	bool kickRequested;
+	AccountName account;
+	bool kickRequested : 1;
+	bool admissionPending : 1;  // Selected a game server but not yet logged on it, see GameData::admitClient
 
 	// Try to add newClient if account is not already in the list (authenticated).
-	// There is at most one account in the hash map.
-	// If the account is already in the hash map, fail: return null and put already connected client data in oldClient
-	// If successful, create a new instance of ClientData with given account added to the hash map
-	// Thread safe
+	// There is at most one account in the index.
+	// If the account is already in the index, fail: return null and put already connected client data in oldClient
+	// If successful, create a new instance of ClientData with given account added to the index
+	// Fail with a null oldClient if the account name is too long to be indexed
+	// Thread safe, accounts are split in shards with their own lock (see ClientIndex)
 	static ClientData* tryAddClient(ClientSession* clientInfo,
 	                                const std::string& account,
 	                                uint32_t accoundId,
@@ -47,8 +52,9 @@ public:
 	static bool removeClient(ClientData* clientData);
 	static ClientData* getClient(const std::string& account);
 	static ClientData* getClientById(uint32_t accountId);
-	static unsigned int getClientCount() { return (int) connectedClients.size(); }
-	static void removeServer(GameData* server);  // remove all client that was connected to this server
+	static unsigned int getClientCount() { return connectedClients.size(); }
+	static void removeServer(GameData* server);        // remove all client that was connected to this server
+	static void removeServerClient(GameData* server);  // remove the first client of server
 
 	void connectedToGame();
 	bool isConnectedToGame() { return inGame; }
@@ -56,22 +62,31 @@ public:
 	ClientSession* getClientSession() { return client; }
 	GameData* getGameServer() { return server; }
 
-protected:
-	static std::string toLower(const std::string& str);
+	// Allocated from a pool (see ObjectPool)
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
+
+	// Memory used by the connected clients index (not the clients)
+	static size_t getIndexAllocatedBytes() { return connectedClients.getAllocatedBytes(); }
 
 private:
-	~ClientData();
+	friend class GameData;
 
-	static uv_mutex_t initializeLock();
+	~ClientData();
 
-	static std::unordered_map<uint32_t, ClientData*> connectedClients;
-	static std::unordered_map<std::string, ClientData*> connectedClientsByName;
-	static uv_mutex_t mapLock;
+	static ClientIndex<ClientData> connectedClients;
 
 	ClientSession* client;  // if != null: not yet in-game
 	GameData* server;       // if != null: in-game or gameserver selected
 	// never both !client && !server
-	bool inGame;
+
+	// Other clients of server, see GameData::addClient
+	ClientData* prevInServer;
+	ClientData* nextInServer;
+
+	uint8_t ipAddress[16];
+	uint8_t ipFamily;  // AF_INET, AF_INET6 or 0 if unknown
+	bool inGame : 1;
 };
 
 }  // namespace AuthServer
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "../OpenHashSet.h"
+#include "AccountName.h"
+#include "uv.h"
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+namespace AuthServer {
+
+// Connected clients indexed by account ID and by account name (case insensitive), both unique.
+// Both indexes only store pointers to clients, keys are read from the clients themselves (no per entry allocation).
+// Each index is split in SHARD_COUNT shards with their own lock so threads working on different accounts don't wait
+// for each other. When both indexes are needed, the ID shard is always locked before the name shard.
+// T must have uint32_t accountId and account (std::string or AccountName) members, they must not change while T is in
+// the index.
+// Removed clients are returned to the caller which must delete them.
+template<class T> class ClientIndex {
+public:
+	static const size_t SHARD_COUNT = 16;
+
+	ClientIndex() : clientCount(0) {}
+
+	// Add the client created by createClient() if neither accountId nor account are already used.
+	// createClient is only called when the insert succeeds, else the already connected client is put in oldClient.
+	// Account names longer than AccountName::MAX_SIZE are refused, oldClient is null then.
+	template<class Factory>
+	T* tryAdd(uint32_t accountId, const std::string& account, Factory createClient, T** oldClient) {
+		AccountNameRef name(account);
+		T* newClient = nullptr;
+
+		*oldClient = nullptr;
+
+		if(name.size > AccountName::MAX_SIZE)
+			return nullptr;
+
+		IdShard& idShard = getShard(idShards, IdHash()(accountId));
+		NameShard& nameShard = getShard(nameShards, NameHash()(name));
+
+		uv_mutex_lock(&idShard.lock);
+		uv_mutex_lock(&nameShard.lock);
+
+		T* idClient = idShard.clients.find(accountId);
+		T* nameClient = nameShard.clients.find(name);
+		if(idClient) {
+			*oldClient = idClient;
+		} else if(nameClient) {
+			*oldClient = nameClient;
+		} else {
+			newClient = createClient();
+			idShard.clients.insert(newClient);
+			nameShard.clients.insert(newClient);
+			clientCount++;
+		}
+
+		uv_mutex_unlock(&nameShard.lock);
+		uv_mutex_unlock(&idShard.lock);
+
+		return newClient;
+	}
+
+	T* findById(uint32_t accountId) {
+		IdShard& shard = getShard(idShards, IdHash()(accountId));
+
+		uv_mutex_lock(&shard.lock);
+		T* client = shard.clients.find(accountId);
+		uv_mutex_unlock(&shard.lock);
+
+		return client;
+	}
+
+	T* find(const std::string& account) {
+		AccountNameRef name(account);
+		NameShard& shard = getShard(nameShards, NameHash()(name));
+
+		uv_mutex_lock(&shard.lock);
+		T* client = shard.clients.find(name);
+		uv_mutex_unlock(&shard.lock);
+
+		return client;
+	}
+
+	// Return the removed client or null if not found
+	T* removeById(uint32_t accountId) {
+		IdShard& idShard = getShard(idShards, IdHash()(accountId));
+
+		uv_mutex_lock(&idShard.lock);
+		T* client = idShard.clients.find(accountId);
+		if(client) {
+			idShard.clients.erase(accountId);
+			removeName(client);
+		}
+		uv_mutex_unlock(&idShard.lock);
+
+		return client;
+	}
+
+	// Return the removed client or null if not found
+	T* remove(const std::string& account) {
+		AccountNameRef name(account);
+		NameShard& nameShard = getShard(nameShards, NameHash()(name));
+		uint32_t accountId = 0;
+
+		// The ID shard must be locked first, so find the ID before removing
+		uv_mutex_lock(&nameShard.lock);
+		T* nameClient = nameShard.clients.find(name);
+		if(nameClient)
+			accountId = nameClient->accountId;
+		uv_mutex_unlock(&nameShard.lock);
+
+		if(!nameClient)
+			return nullptr;
+
+		IdShard& idShard = getShard(idShards, IdHash()(accountId));
+		T* removedClient = nullptr;
+
+		uv_mutex_lock(&idShard.lock);
+		T* client = idShard.clients.find(accountId);
+		// Check the account was not removed or replaced by another thread meanwhile
+		if(client && AccountNameEqual()(client->account, name)) {
+			removedClient = client;
+			idShard.clients.erase(accountId);
+			removeName(removedClient);
+		}
+		uv_mutex_unlock(&idShard.lock);
+
+		return removedClient;
+	}
+
+	unsigned int size() const { return clientCount; }
+
+	// Memory used by the index itself (not the clients)
+	size_t getAllocatedBytes() {
+		size_t bytes = sizeof(*this);
+
+		for(size_t i = 0; i < SHARD_COUNT; i++) {
+			uv_mutex_lock(&idShards[i].lock);
+			bytes += idShards[i].clients.getAllocatedBytes();
+			uv_mutex_unlock(&idShards[i].lock);
+
+			uv_mutex_lock(&nameShards[i].lock);
+			bytes += nameShards[i].clients.getAllocatedBytes();
+			uv_mutex_unlock(&nameShards[i].lock);
+		}
+
+		return bytes;
+	}
+
+private:
+	struct IdHash {
+		size_t operator()(uint32_t accountId) const {
+			// Account IDs are sequential, mix them so they spread over shards and table slots
+			uint64_t hash = (uint64_t) accountId * 0x9E3779B97F4A7C15ULL;
+			return (size_t) (hash ^ (hash >> 32));
+		}
+		size_t operator()(const T* client) const { return (*this)(client->accountId); }
+	};
+	struct IdEqual {
+		bool operator()(const T* client, uint32_t accountId) const { return client->accountId == accountId; }
+		bool operator()(const T* client, const T* other) const { return client->accountId == other->accountId; }
+	};
+	struct NameHash {
+		size_t operator()(AccountNameRef account) const { return AccountNameHash()(account); }
+		size_t operator()(const T* client) const { return AccountNameHash()(client->account); }
+	};
+	struct NameEqual {
+		bool operator()(const T* client, AccountNameRef account) const {
+			return AccountNameEqual()(client->account, account);
+		}
+		bool operator()(const T* client, const T* other) const {
+			return AccountNameEqual()(client->account, other->account);
+		}
+	};
+
+	template<class Hash, class Equal> struct Shard {
+		uv_mutex_t lock;
+		OpenHashSet<T, Hash, Equal> clients;
+
+		Shard() { uv_mutex_init(&lock); }
+		~Shard() { uv_mutex_destroy(&lock); }
+	};
+	typedef Shard<IdHash, IdEqual> IdShard;
+	typedef Shard<NameHash, NameEqual> NameShard;
+
+	// Use different bits than OpenHashSet slots (low bits) to select the shard
+	template<class ShardType> static ShardType& getShard(ShardType (&shards)[SHARD_COUNT], size_t hash) {
+		return shards[(hash >> 24) % SHARD_COUNT];
+	}
+
+	// The ID shard of client must be locked
+	void removeName(T* client) {
+		AccountNameRef name(client->account);
+		NameShard& nameShard = getShard(nameShards, NameHash()(name));
+
+		uv_mutex_lock(&nameShard.lock);
+		nameShard.clients.erase(name);
+		uv_mutex_unlock(&nameShard.lock);
+
+		clientCount--;
+	}
+
+	IdShard idShards[SHARD_COUNT];
+	NameShard nameShards[SHARD_COUNT];
+	std::atomic<unsigned int> clientCount;
+};
+
+}  // namespace AuthServer
@@ -1,15 +1,23 @@
 #include "ClientSession.h"
 #include "../GlobalConfig.h"
+#include "../MetricsExporter.h"
+#include "../PacketLatency.h"
+#include "../SecureRandom.h"
+#include "../ThreadCipherContext.h"
+#include "AccountBatcher.h"
+#include "AccountCache.h"
 #include "ClientData.h"
+#include "CryptoWorkerPool.h"
 #include "GameData.h"
+#include "LastServerIdxUpdater.h"
+#include "LoginTracer.h"
+#include "RsaKeyExchangeJob.h"
+#include "ServerListCache.h"
 #include "rzauthGitVersion.h"
 
-#include <stdlib.h>
 #include <string.h>
 
-#include <openssl/err.h>
-#include <openssl/pem.h>
-#include <openssl/rsa.h>
+#include <openssl/evp.h>
 
 #include "LogServerClient.h"
 
@@ -22,26 +30,55 @@
 #include "AuthClient/Flat/TS_CA_SELECT_SERVER.h"
 #include "AuthClient/Flat/TS_CA_SERVER_LIST.h"
 #include "AuthClient/Flat/TS_CA_VERSION.h"
-#include "AuthClient/TS_AC_SERVER_LIST.h"
 #include "GameClient/TS_SC_RESULT.h"
 #include "Packet/PacketEpics.h"
 
 namespace AuthServer {
 
+static MemoryCounter clientSessionMemory("AuthServer::ClientSession");
+
 ClientSession::ClientSession()
     : EncryptedSession<PacketSession>(SessionType::AuthClient, SessionPacketOrigin::Server, EPIC_LATEST),
       useRsaAuth(false),
       isEpic2(false),
       lastLoginServerId(1),
       serverIdxOffset(0),
-      clientData(nullptr) {}
+      clientData(nullptr),
+      rsaKeyJob(nullptr),
+      accountBatch(nullptr),
+      rsaKeyRequestTime(0),
+      accountRequestTime(0),
+      accountRequestPacketId(0),
+      accountRequestPending(false),
+      traceId(LoginTracer::get()->startTrace()),
+      memoryUsage(clientSessionMemory, sizeof(ClientSession)) {
+	LoginTracer::record(traceId, LTS_Connection, LTE_Instant);
+}
 
 ClientSession::~ClientSession() {
+	if(rsaKeyJob)
+		rsaKeyJob->cancel();
+	if(accountBatch)
+		accountBatch->cancel(this);
 	if(clientData)
 		ClientData::removeClient(clientData);
+	if(accountRequestPending)
+		MetricsExporter::get()->removePendingAccountRequest();
 }
 
 EventChain<SocketSession> ClientSession::onDisconnected(bool causedByRemote) {
+	LoginTracer::record(traceId, LTS_Disconnection, LTE_Instant);
+
+	if(rsaKeyJob) {
+		rsaKeyJob->cancel();
+		rsaKeyJob = nullptr;
+	}
+
+	if(accountBatch) {
+		accountBatch->cancel(this);
+		accountBatch = nullptr;
+	}
+
 	if(clientData) {
 		ClientData::removeClient(clientData);
 		clientData = nullptr;
@@ -53,6 +90,8 @@ EventChain<SocketSession> ClientSession::onDisconnected(bool causedByRemote) {
 EventChain<PacketSession> ClientSession::onPacketReceived(const TS_MESSAGE* packet) {
 	packet_type_id_t packetType = PacketMetadata::convertPacketIdToTypeId(
 	    packet->id, SessionType::AuthClient, SessionPacketOrigin::Client, packetVersion);
+	uint64_t startTime = uv_hrtime();
+
 	switch(packetType) {
 		case TS_CA_VERSION::packetID:
 			onVersion(static_cast<const TS_CA_VERSION*>(packet));
@@ -71,11 +110,15 @@ EventChain<PacketSession> ClientSession::onPacketReceived(const TS_MESSAGE* pack
 			break;
 
 		case TS_CA_SERVER_LIST::packetID:
+			LoginTracer::record(traceId, LTS_ServerList, LTE_Begin);
 			onServerList(static_cast<const TS_CA_SERVER_LIST*>(packet));
+			LoginTracer::record(traceId, LTS_ServerList, LTE_End);
 			break;
 
 		case TS_CA_SELECT_SERVER::packetID:
+			LoginTracer::record(traceId, LTS_SelectServer, LTE_Begin);
 			onSelectServer(static_cast<const TS_CA_SELECT_SERVER*>(packet));
+			LoginTracer::record(traceId, LTS_SelectServer, LTE_End);
 			break;
 
 		case 9999:
@@ -83,9 +126,12 @@ EventChain<PacketSession> ClientSession::onPacketReceived(const TS_MESSAGE* pack
 
 		default:
 			log(LL_Debug, "Unknown packet ID: %d, size: %d\n", packet->id, packet->size);
-			break;
+			// Not recorded, the peer could create a histogram for each packet ID
+			return PacketSession::onPacketReceived(packet);
 	}
 
+	PacketLatency::record(PacketLatency::AuthClient, PacketLatency::Handler, packetType, uv_hrtime() - startTime);
+
 	return PacketSession::onPacketReceived(packet);
 }
 
@@ -119,9 +165,6 @@ void ClientSession::onVersion(const TS_CA_VERSION* packet) {
 }
 
 void ClientSession::onRsaKey(const TS_CA_RSA_PUBLIC_KEY* packet) {
-	std::unique_ptr<RSA, void (*)(RSA*)> rsaCipher(nullptr, &RSA_free);
-	std::unique_ptr<BIO, int (*)(BIO*)> bio(nullptr, &BIO_free);
-
 	const int expectedKeySize = packet->size - sizeof(TS_CA_RSA_PUBLIC_KEY);
 
 	if(packet->key_size != expectedKeySize) {
@@ -133,47 +176,63 @@ void ClientSession::onRsaKey(const TS_CA_RSA_PUBLIC_KEY* packet) {
 		return;
 	}
 
-	ERR_clear_error();
+	if(rsaKeyJob) {
+		log(LL_Warning, "RSA: key exchange already in progress\n");
+		abortSession();
+		return;
+	}
 
-	bio.reset(BIO_new_mem_buf((void*) packet->key, packet->key_size));
-	rsaCipher.reset(PEM_read_bio_RSA_PUBKEY(bio.get(), NULL, NULL, NULL));
-	if(!rsaCipher) {
-		log(LL_Warning, "RSA: invalid certificate: %s\n", ERR_error_string(ERR_get_error(), nullptr));
+	if(!SecureRandom::getBytes(aesKey, sizeof(aesKey))) {
+		log(LL_Error, "RSA: can't generate AES key\n");
 		abortSession();
 		return;
 	}
 
-	std::unique_ptr<TS_AC_AES_KEY_IV, void (*)(TS_MESSAGE*)> aesKeyMessage(
-	    TS_MESSAGE_WNA::create<TS_AC_AES_KEY_IV, unsigned char>(RSA_size(rsaCipher.get())), &TS_MESSAGE_WNA::destroy);
+	// RSA is done in a crypto thread, onRsaKeyExchanged will be called when done
+	int keyCacheSize = CONFIG_GET()->auth.client.rsaKeyCacheSize.get();
+	rsaKeyRequestTime = uv_hrtime();
+	LoginTracer::record(traceId, LTS_RsaKeyExchange, LTE_Begin);
+	rsaKeyJob = new RsaKeyExchangeJob(this, packet->key, packet->key_size, aesKey, keyCacheSize > 0 ? keyCacheSize : 0);
+	if(!CryptoWorkerPool::get()->post(rsaKeyJob)) {
+		delete rsaKeyJob;
+		rsaKeyJob = nullptr;
+		log(LL_Warning, "RSA: too many pending key exchanges, dropping client\n");
+		abortSession();
+	}
+}
+
+void ClientSession::onRsaKeyExchanged(RsaKeyExchangeJob* job) {
+	const TS_AC_AES_KEY_IV* aesKeyMessage = job->getAesKeyMessage();
 
-	for(int i = 0; i < 32; i++)
-		aesKey[i] = rand() & 0xFF;
+	rsaKeyJob = nullptr;
+	PacketLatency::record(PacketLatency::AuthClient,
+	                      PacketLatency::Response,
+	                      TS_CA_RSA_PUBLIC_KEY::packetID,
+	                      uv_hrtime() - rsaKeyRequestTime);
+	LoginTracer::record(traceId, LTS_RsaKeyExchange, LTE_End);
 
-	int blockSize =
-	    RSA_public_encrypt(32, aesKey, aesKeyMessage->rsa_encrypted_data, rsaCipher.get(), RSA_PKCS1_PADDING);
-	if(blockSize < 0) {
-		log(LL_Warning, "RSA: encrypt error: %s\n", ERR_error_string(ERR_get_error(), nullptr));
+	if(!aesKeyMessage) {
+		log(LL_Warning, "%s\n", job->getErrorMessage().c_str());
 		abortSession();
 		return;
 	}
 
-	aesKeyMessage->data_size = blockSize;
-
 	useRsaAuth = true;
-	sendPacket(aesKeyMessage.get());
+	sendPacket(aesKeyMessage);
 }
 
 void ClientSession::onAccount(const TS_CA_ACCOUNT* packet) {
 	std::string account;
 	std::vector<unsigned char> cryptedPassword;
 
-	if(dbQuery.inProgress()) {
+	if(isAuthInProgress()) {
 		TS_AC_RESULT result;
 		TS_MESSAGE::initMessage<TS_AC_RESULT>(&result);
 		result.request_msg_id = TS_CA_ACCOUNT::packetID;
 		result.result = TS_RESULT_CLIENT_SIDE_ERROR;
 		result.login_flag = 0;
 		sendPacket(&result);
+		MetricsExporter::get()->countLoginResult(result.result);
 		log(LL_Info, "Client connection with a auth request already in progress\n");
 		return;
 	}
@@ -207,20 +266,22 @@ void ClientSession::onAccount(const TS_CA_ACCOUNT* packet) {
 	                            useRsaAuth ? DB_AccountData::EM_AES : DB_AccountData::EM_DES,
 	                            cryptedPassword,
 	                            aesKey);
-	dbQuery.executeDbQuery<DB_AccountData, DB_Account>(this, &ClientSession::clientAuthResult, input);
+	input.traceId = traceId;
+	queryAccount(TS_CA_ACCOUNT::packetID, input);
 }
 
 void ClientSession::onImbcAccount(const TS_CA_IMBC_ACCOUNT* packet) {
 	std::string account;
 	std::vector<unsigned char> cryptedPassword;
 
-	if(dbQuery.inProgress()) {
+	if(isAuthInProgress()) {
 		TS_AC_RESULT result;
 		TS_MESSAGE::initMessage<TS_AC_RESULT>(&result);
 		result.request_msg_id = TS_CA_ACCOUNT::packetID;
 		result.result = TS_RESULT_CLIENT_SIDE_ERROR;
 		result.login_flag = 0;
 		sendPacket(&result);
+		MetricsExporter::get()->countLoginResult(result.result);
 		log(LL_Info, "Client IMBC connection with a auth request already in progress\n");
 		return;
 	}
@@ -247,6 +308,7 @@ void ClientSession::onImbcAccount(const TS_CA_IMBC_ACCOUNT* packet) {
 		result.result = TS_RESULT_ACCESS_DENIED;
 		result.login_flag = 0;
 		sendPacket(&result);
+		MetricsExporter::get()->countLoginResult(result.result);
 		log(LL_Debug, "Refused IMBC connection (IMBC is disabled) for account %s\n", account.c_str());
 	} else {
 		log(LL_Debug, "IMBC Login request for account %s\n", account.c_str());
@@ -256,27 +318,68 @@ void ClientSession::onImbcAccount(const TS_CA_IMBC_ACCOUNT* packet) {
 		                            useRsaAuth ? DB_AccountData::EM_AES : DB_AccountData::EM_None,
 		                            cryptedPassword,
 		                            aesKey);
-		dbQuery.executeDbQuery<DB_AccountData, DB_Account>(this, &ClientSession::clientAuthResult, input);
+		input.traceId = traceId;
+		queryAccount(TS_CA_IMBC_ACCOUNT::packetID, input);
 	}
 }
 
+bool ClientSession::isAuthInProgress() {
+	// Also refuse logins while the AES key is not yet sent
+	return dbQuery.inProgress() || accountBatch || rsaKeyJob;
+}
+
+void ClientSession::queryAccount(uint16_t requestPacketId, const DB_AccountData::Input& input) {
+	accountRequestTime = uv_hrtime();
+	accountRequestPacketId = requestPacketId;
+	accountRequestPending = true;
+	MetricsExporter::get()->addPendingAccountRequest();
+	LoginTracer::record(traceId, LTS_AccountQueue, LTE_Begin);
+
+	if(!AccountBatcher::get()->addRequest(this, input))
+		dbQuery.executeDbQuery<DB_AccountData, DB_Account>(this, &ClientSession::clientAuthResult, input);
+}
+
 void ClientSession::clientAuthResult(DB_Account* query) {
+	auto& results = query->getResults();
+
+	if(results.size() == 0 || results.size() > 1)
+		onAuthResult(query->getInput(), nullptr);
+	else
+		onAuthResult(query->getInput(), results.front().get());
+}
+
+void ClientSession::onAccountBatchResult(const DB_AccountData::Input* input, const DB_AccountData::Output* output) {
+	accountBatch = nullptr;
+	onAuthResult(input, output);
+}
+
+void ClientSession::onAuthResult(const DB_AccountData::Input* input, const DB_AccountData::Output* output) {
 	TS_AC_RESULT result;
 	TS_MESSAGE::initMessage<TS_AC_RESULT>(&result);
 
+	PacketLatency::record(PacketLatency::AuthClient,
+	                      PacketLatency::Response,
+	                      accountRequestPacketId,
+	                      uv_hrtime() - accountRequestTime);
+	if(accountRequestPending) {
+		accountRequestPending = false;
+		MetricsExporter::get()->removePendingAccountRequest();
+	}
+	// Close the DB execution of queries without any row or not executed
+	LoginTracer::record(traceId, LTS_DbExecute, LTE_End);
+	LoginTracer::record(traceId, LTS_AccountResult, LTE_Begin);
+
 	result.request_msg_id = TS_CA_ACCOUNT::packetID;
 	result.login_flag = 0;
 
-	auto& results = query->getResults();
-	if(results.size() == 0 || results.size() > 1) {
+	if(!output) {
 		result.result = TS_RESULT_NOT_EXIST;
 		sendPacket(&result);
+		MetricsExporter::get()->countLoginResult(result.result);
+		LoginTracer::record(traceId, LTS_AccountResult, LTE_End);
 		return;
 	}
 
-	const DB_AccountData::Output* output = results.front().get();
-	const DB_AccountData::Input* input = query->getInput();
-
 	if(output->ok == false || output->auth_ok == false) {
 		result.result = TS_RESULT_NOT_EXIST;
 		result.login_flag = 0;
@@ -295,12 +398,18 @@ void ClientSession::clientAuthResult(DB_Account* query) {
 
 		clientData = ClientData::tryAddClient(
 		    this, input->account, output->account_id, output->age, output->event_code, output->pcbang, ip, &oldClient);
-		if(clientData == nullptr) {
+		if(clientData == nullptr && oldClient == nullptr) {
+			result.result = TS_RESULT_ACCESS_DENIED;
+			result.login_flag = 0;
+		} else if(clientData == nullptr) {
+			LoginTracer::record(traceId, LTS_DuplicateKick, LTE_Begin);
 			result.result = TS_RESULT_ALREADY_EXIST;
 			result.login_flag = 0;
 			log(LL_Info, "Client %s already connected\n", input->account.c_str());
 
 			GameData* oldCientGameData = oldClient->getGameServer();
+			char oldClientIp[INET6_ADDRSTRLEN];
+			oldClient->getIp(oldClientIp);
 
 			if(!oldCientGameData) {
 				LogServerClient::sendLog(LogServerClient::LM_ACCOUNT_DUPLICATE_AUTH_LOGIN,
@@ -319,7 +428,7 @@ void ClientSession::clientAuthResult(DB_Account* query) {
 				                         -1,
 				                         ip,
 				                         -1,
-				                         oldClient->ip,
+				                         oldClientIp,
 				                         -1,
 				                         0,
 				                         0);
@@ -342,7 +451,7 @@ void ClientSession::clientAuthResult(DB_Account* query) {
 				                         -1,
 				                         ip,
 				                         -1,
-				                         oldClient->ip,
+				                         oldClientIp,
 				                         -1,
 				                         0,
 				                         0);
@@ -353,6 +462,7 @@ void ClientSession::clientAuthResult(DB_Account* query) {
 					ClientData::removeClient(oldClient);
 				}
 			}
+			LoginTracer::record(traceId, LTS_DuplicateKick, LTE_End);
 		} else {
 			result.result = 0;
 			result.login_flag = TS_AC_RESULT::LSF_EULA_ACCEPTED;
@@ -362,11 +472,11 @@ void ClientSession::clientAuthResult(DB_Account* query) {
 	}
 
 	sendPacket(&result);
+	MetricsExporter::get()->countLoginResult(result.result);
+	LoginTracer::record(traceId, LTS_AccountResult, LTE_End);
 }
 
 void ClientSession::onServerList(const TS_CA_SERVER_LIST* packet) {
-	TS_AC_SERVER_LIST serverListPacket;
-
 	int maxPublicServerBaseIdx = CONFIG_GET()->auth.client.maxPublicServerIdx;
 
 	// Check if user authenticated
@@ -375,43 +485,14 @@ void ClientSession::onServerList(const TS_CA_SERVER_LIST* packet) {
 		return;
 	}
 
-	const std::unordered_map<uint16_t, GameData*>& serverList = GameData::getServerList();
-	std::unordered_map<uint16_t, GameData*>::const_iterator it, itEnd;
-
-	unsigned int maxPlayers = CONFIG_GET()->auth.game.maxPlayers;
-
-	serverListPacket.servers.reserve(serverList.size());
-	serverListPacket.last_login_server_idx = lastLoginServerId;
-
-	for(it = serverList.cbegin(), itEnd = serverList.cend(); it != itEnd; ++it) {
-		GameData* serverInfo = it->second;
-
-		// servers with their index higher than maxPublicServerBaseIdx + serverIdxOffset are hidden
-		// serverIdxOffset is a per user value from the DB, default to 0
-		// maxPublicServerBaseIdx is a config value, default to 30
-		// So by default, servers with index > 30 are not shown in client's server list
-		if(serverInfo->getServerIdx() > maxPublicServerBaseIdx + serverIdxOffset)
-			continue;
-
-		// Don't display not ready game servers (offline or not yet received all player list)
-		if(!serverInfo->isReady())
-			continue;
-
-		serverListPacket.servers.push_back(TS_SERVER_INFO());
-		TS_SERVER_INFO& serverData = serverListPacket.servers.back();
-
-		serverData.server_idx = serverInfo->getServerIdx();
-		serverData.server_port = serverInfo->getServerPort();
-		serverData.is_adult_server = serverInfo->getIsAdultServer();
-		serverData.server_ip = serverInfo->getServerIp();
-		serverData.server_name = serverInfo->getServerName();
-		serverData.server_screenshot_url = serverInfo->getServerScreenshotUrl();
-
-		uint32_t userRatio = serverInfo->getPlayerCount() * 100 / maxPlayers;
-		serverData.user_ratio = (userRatio > 100) ? 100 : userRatio;
-	}
-
-	sendPacket(serverListPacket, isEpic2 ? EPIC_2 : EPIC_9_1);
+	// servers with their index higher than maxPublicServerBaseIdx + serverIdxOffset are hidden
+	// The message is shared by all clients with the same parameters and rebuilt only when a game server change
+	const TS_MESSAGE* serverListMessage =
+	    ServerListCache::getServerList(isEpic2, maxPublicServerBaseIdx + serverIdxOffset, lastLoginServerId);
+	if(serverListMessage)
+		sendPacket(serverListMessage);
+	else
+		abortSession();
 }
 
 void ClientSession::onSelectServer(const TS_CA_SELECT_SERVER* packet) {
@@ -424,43 +505,54 @@ void ClientSession::onSelectServer(const TS_CA_SELECT_SERVER* packet) {
 
 	if(serverList.find(packet->server_idx) != serverList.end()) {
 		GameData* server = serverList.at(packet->server_idx);
-		uint64_t oneTimePassword = ((uint64_t) rand()) * rand() * rand() * rand();
+		uint64_t oneTimePassword;
+
+		if(!SecureRandom::get(&oneTimePassword)) {
+			log(LL_Error, "Can't generate one time password\n");
+			abortSession();
+			return;
+		}
+
+		LastServerIdxUpdater::get()->update(clientData->accountId, packet->server_idx);
+		AccountCache::get()->updateLastServerIdx(clientData->account.c_str(), packet->server_idx);
 
-		DbQueryJob<DB_UpdateLastServerIdx>::executeNoResult(
-		    DB_UpdateLastServerIdx::Input(clientData->accountId, packet->server_idx));
+		// Spread logins when many clients select the same game server
+		uint32_t pendingTime = server->admitClient(clientData);
 
 		// clientData now managed by target GS
 		clientData->switchClientToServer(server, oneTimePassword);
 		clientData = nullptr;
 
-		log(LL_Debug, "Client choose server idx %d\n", packet->server_idx);
+		if(pendingTime)
+			log(LL_Debug, "Client choose server idx %d, must wait %d seconds\n", packet->server_idx, pendingTime);
+		else
+			log(LL_Debug, "Client choose server idx %d\n", packet->server_idx);
 
 		if(useRsaAuth) {
 			TS_AC_SELECT_SERVER_RSA result;
 			TS_MESSAGE::initMessage<TS_AC_SELECT_SERVER_RSA>(&result);
 			result.result = 0;
 			result.encrypted_data_size = 16;
-			result.pending_time = 0;
+			result.pending_time = pendingTime;
 			result.unknown = 0;
 			result.unknown2 = 0;
 
-			std::unique_ptr<EVP_CIPHER_CTX, void (*)(EVP_CIPHER_CTX*)> e_ctx(nullptr, &EVP_CIPHER_CTX_free);
+			EVP_CIPHER_CTX* e_ctx = ThreadCipherContext::get();
 			int bytesWritten;
 			bool ok = false;
 
-			e_ctx.reset(EVP_CIPHER_CTX_new());
 			if(!e_ctx)
 				goto cleanup;
 
-			if(EVP_EncryptInit_ex(e_ctx.get(), EVP_aes_128_cbc(), NULL, aesKey, aesKey + 16) < 0)
+			if(EVP_EncryptInit_ex(e_ctx, EVP_aes_128_cbc(), NULL, aesKey, aesKey + 16) < 0)
 				goto cleanup;
-			if(EVP_EncryptUpdate(e_ctx.get(),
+			if(EVP_EncryptUpdate(e_ctx,
 			                     result.encrypted_data,
 			                     &bytesWritten,
 			                     (const unsigned char*) &oneTimePassword,
 			                     sizeof(uint64_t)) < 0)
 				goto cleanup;
-			if(EVP_EncryptFinal_ex(e_ctx.get(), result.encrypted_data + bytesWritten, &bytesWritten) < 0)
+			if(EVP_EncryptFinal_ex(e_ctx, result.encrypted_data + bytesWritten, &bytesWritten) < 0)
 				goto cleanup;
 
 			sendPacket(&result);
@@ -475,7 +567,7 @@ void ClientSession::onSelectServer(const TS_CA_SELECT_SERVER* packet) {
 
 			result.result = 0;
 			result.one_time_key = oneTimePassword;
-			result.pending_time = 0;
+			result.pending_time = pendingTime;
 
 			sendPacket(&result);
 		}
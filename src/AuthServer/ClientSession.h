@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../MemoryCounter.h"
 #include "DB_Account.h"
 #include "DB_UpdateLastServerIdx.h"
 #include "NetSession/EncryptedSession.h"
@@ -15,7 +16,9 @@ struct TS_CA_SELECT_SERVER;
 
 namespace AuthServer {
 
+class AccountBatch;
 class ClientData;
+class RsaKeyExchangeJob;
 
 class ClientSession : public EncryptedSession<PacketSession> {
 	DECLARE_CLASS(AuthServer::ClientSession)
@@ -24,6 +27,11 @@ public:
 	ClientSession();
 
 	void clientAuthResult(DB_Account* query);
+	void onRsaKeyExchanged(RsaKeyExchangeJob* job);
+
+	// Batched account queries, see AccountBatcher
+	void setAccountBatch(AccountBatch* batch) { accountBatch = batch; }
+	void onAccountBatchResult(const DB_AccountData::Input* input, const DB_AccountData::Output* output);
 
 protected:
 	EventChain<PacketSession> onPacketReceived(const TS_MESSAGE* packet);
@@ -36,6 +44,12 @@ protected:
 	void onServerList(const TS_CA_SERVER_LIST* packet);
 	void onSelectServer(const TS_CA_SELECT_SERVER* packet);
 
+	// requestPacketId is the account packet type, used for the response latency (see PacketLatency)
+	void queryAccount(uint16_t requestPacketId, const DB_AccountData::Input& input);
+	bool isAuthInProgress();
+	// output is null if the account was not found
+	void onAuthResult(const DB_AccountData::Input* input, const DB_AccountData::Output* output);
+
 private:
 	~ClientSession();
 
@@ -47,6 +61,18 @@ private:
 
 	ClientData* clientData;
 	DbQueryJobRef dbQuery;
+	RsaKeyExchangeJob* rsaKeyJob;
+	AccountBatch* accountBatch;
+
+	// Start of asynchronous requests, for PacketLatency
+	uint64_t rsaKeyRequestTime;
+	uint64_t accountRequestTime;
+	uint16_t accountRequestPacketId;
+	bool accountRequestPending;  // Counted in MetricsExporter until the result is received
+
+	uint32_t traceId;  // See LoginTracer
+
+	TrackedMemory memoryUsage;
 };
 
 }  // namespace AuthServer
@@ -0,0 +1,175 @@
+#include "CryptoWorkerPool.h"
+#include "Console/ConsoleCommands.h"
+#include "Core/EventLoop.h"
+
+namespace AuthServer {
+
+void CryptoWorkerPool::init() {
+	ConsoleCommands::get()->addCommand("crypto.stats",
+	                                   "cryptostats",
+	                                   0,
+	                                   0,
+	                                   &commandStats,
+	                                   "Show crypto worker pool statistics",
+	                                   "crypto.stats : show crypto jobs count and latencies");
+}
+
+CryptoWorkerPool* CryptoWorkerPool::get() {
+	static CryptoWorkerPool pool;
+	return &pool;
+}
+
+CryptoWorkerPool::CryptoWorkerPool()
+    : stopRequested(false),
+      started(false),
+      inProgressJobs(0),
+      maxInProgressJobs(0),
+      completedJobs(0),
+      rejectedJobs(0) {
+	uv_mutex_init(&lock);
+	uv_cond_init(&jobAvailable);
+}
+
+CryptoWorkerPool::~CryptoWorkerPool() {
+	stop();
+	uv_cond_destroy(&jobAvailable);
+	uv_mutex_destroy(&lock);
+}
+
+void CryptoWorkerPool::start(int threadCount, int maxPendingJobs) {
+	if(started)
+		return;
+
+	if(threadCount < 1)
+		threadCount = 1;
+	if(maxPendingJobs < 1)
+		maxPendingJobs = 1;
+
+	maxInProgressJobs = maxPendingJobs;
+	stopRequested = false;
+
+	uv_async_init(EventLoop::getLoop(), &doneAsync, &onJobsDone);
+	doneAsync.data = this;
+	// Don't keep the event loop alive just for this
+	uv_unref((uv_handle_t*) &doneAsync);
+
+	threads.resize(threadCount);
+	for(size_t i = 0; i < threads.size(); i++)
+		uv_thread_create(&threads[i], &workerThread, this);
+
+	started = true;
+	log(LL_Debug, "Started %d crypto threads\n", threadCount);
+}
+
+void CryptoWorkerPool::stop() {
+	if(!started)
+		return;
+
+	uv_mutex_lock(&lock);
+	stopRequested = true;
+	uv_cond_broadcast(&jobAvailable);
+	uv_mutex_unlock(&lock);
+
+	for(size_t i = 0; i < threads.size(); i++)
+		uv_thread_join(&threads[i]);
+	threads.clear();
+
+	// Jobs not completed are dropped, their sessions are being destroyed anyway
+	for(size_t i = 0; i < pendingJobs.size(); i++)
+		delete pendingJobs[i];
+	pendingJobs.clear();
+	for(size_t i = 0; i < doneJobs.size(); i++)
+		delete doneJobs[i];
+	doneJobs.clear();
+	inProgressJobs = 0;
+
+	uv_close((uv_handle_t*) &doneAsync, nullptr);
+	started = false;
+}
+
+bool CryptoWorkerPool::post(Job* job) {
+	if(!started || inProgressJobs >= maxInProgressJobs) {
+		rejectedJobs++;
+		return false;
+	}
+
+	inProgressJobs++;
+	job->postTime = uv_hrtime();
+
+	uv_mutex_lock(&lock);
+	pendingJobs.push_back(job);
+	uv_cond_signal(&jobAvailable);
+	uv_mutex_unlock(&lock);
+
+	return true;
+}
+
+void CryptoWorkerPool::workerThread(void* arg) {
+	CryptoWorkerPool* thisInstance = (CryptoWorkerPool*) arg;
+
+	uv_mutex_lock(&thisInstance->lock);
+	while(!thisInstance->stopRequested) {
+		if(thisInstance->pendingJobs.empty()) {
+			uv_cond_wait(&thisInstance->jobAvailable, &thisInstance->lock);
+			continue;
+		}
+
+		Job* job = thisInstance->pendingJobs.front();
+		thisInstance->pendingJobs.pop_front();
+		uv_mutex_unlock(&thisInstance->lock);
+
+		job->startTime = uv_hrtime();
+		job->onProcess();
+		job->endTime = uv_hrtime();
+
+		uv_mutex_lock(&thisInstance->lock);
+		thisInstance->doneJobs.push_back(job);
+		uv_async_send(&thisInstance->doneAsync);
+	}
+	uv_mutex_unlock(&thisInstance->lock);
+}
+
+void CryptoWorkerPool::onJobsDone(uv_async_t* handle) {
+	CryptoWorkerPool* thisInstance = (CryptoWorkerPool*) handle->data;
+	std::vector<Job*> jobs;
+
+	uv_mutex_lock(&thisInstance->lock);
+	jobs.swap(thisInstance->doneJobs);
+	uv_mutex_unlock(&thisInstance->lock);
+
+	uint64_t now = uv_hrtime();
+
+	for(size_t i = 0; i < jobs.size(); i++) {
+		Job* job = jobs[i];
+
+		thisInstance->queueLatency.add(job->startTime - job->postTime);
+		thisInstance->processLatency.add(job->endTime - job->startTime);
+		thisInstance->totalLatency.add(now - job->postTime);
+		thisInstance->completedJobs++;
+		thisInstance->inProgressJobs--;
+
+		job->onDone();
+		delete job;
+	}
+}
+
+void CryptoWorkerPool::commandStats(IWritableConsole* console, const std::vector<std::string>& args) {
+	CryptoWorkerPool* pool = get();
+	uint64_t count = pool->completedJobs ? pool->completedJobs : 1;
+
+	console->writef("Crypto jobs: threads: %d, in progress: %d/%d, completed: %llu, rejected: %llu\r\n",
+	                (int) pool->threads.size(),
+	                (int) pool->inProgressJobs,
+	                (int) pool->maxInProgressJobs,
+	                (unsigned long long) pool->completedJobs,
+	                (unsigned long long) pool->rejectedJobs);
+	console->writef("Latency (avg/max in us): queue: %llu/%llu, process: %llu/%llu, total: %llu/%llu\r\n",
+	                (unsigned long long) (pool->queueLatency.total / count / 1000),
+	                (unsigned long long) (pool->queueLatency.max / 1000),
+	                (unsigned long long) (pool->processLatency.total / count / 1000),
+	                (unsigned long long) (pool->processLatency.max / 1000),
+	                (unsigned long long) (pool->totalLatency.total / count / 1000),
+	                (unsigned long long) (pool->totalLatency.max / 1000));
+}
+
+}  // namespace AuthServer
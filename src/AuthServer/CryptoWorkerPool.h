@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Core/Object.h"
+#include "uv.h"
+#include <deque>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class IWritableConsole;
+
+namespace AuthServer {
+
+// Run CPU heavy crypto operations (RSA) in dedicated threads so the event loop is never blocked by them.
+// Jobs are posted from the event loop, processed by a worker thread and then completed back in the event loop.
+class CryptoWorkerPool : public Object {
+	DECLARE_CLASS(AuthServer::CryptoWorkerPool)
+
+public:
+	class Job {
+	public:
+		Job() : postTime(0), startTime(0), endTime(0) {}
+		virtual ~Job() {}
+
+	protected:
+		friend class CryptoWorkerPool;
+
+		// Called in a worker thread, must not touch any session or event loop object
+		virtual void onProcess() = 0;
+		// Called in the event loop thread once onProcess is done, the job is deleted after that
+		virtual void onDone() = 0;
+
+	private:
+		uint64_t postTime;
+		uint64_t startTime;
+		uint64_t endTime;
+	};
+
+	static void init();
+	static CryptoWorkerPool* get();
+
+	void start(int threadCount, int maxPendingJobs);
+	void stop();
+
+	// Take ownership of job. Return false if the queue is full or the pool not started, job is not deleted then
+	bool post(Job* job);
+
+protected:
+	static void commandStats(IWritableConsole* console, const std::vector<std::string>& args);
+
+private:
+	CryptoWorkerPool();
+	~CryptoWorkerPool();
+
+	static void workerThread(void* arg);
+	static void onJobsDone(uv_async_t* handle);
+
+	struct LatencyStat {
+		uint64_t total;
+		uint64_t max;
+
+		LatencyStat() : total(0), max(0) {}
+		void add(uint64_t value) {
+			total += value;
+			if(value > max)
+				max = value;
+		}
+	};
+
+	uv_mutex_t lock;
+	uv_cond_t jobAvailable;
+	std::deque<Job*> pendingJobs;
+	std::vector<Job*> doneJobs;
+	bool stopRequested;
+
+	std::vector<uv_thread_t> threads;
+	uv_async_t doneAsync;
+	bool started;
+
+	// Only used in the event loop thread
+	size_t inProgressJobs;
+	size_t maxInProgressJobs;
+	uint64_t completedJobs;
+	uint64_t rejectedJobs;
+	LatencyStat queueLatency;
+	LatencyStat processLatency;
+	LatencyStat totalLatency;
+};
+
+}  // namespace AuthServer
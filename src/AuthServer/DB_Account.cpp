@@ -1,10 +1,15 @@
 #include "DB_Account.h"
 #include "../GlobalConfig.h"
+#include "../SaltedMd5.h"
+#include "../ThreadCipherContext.h"
+#include "AccountCache.h"
 #include "Cipher/DesPasswordCipher.h"
 #include "ClientSession.h"
+#include "LoginTracer.h"
+#include <memory>
 #include <openssl/err.h>
 #include <openssl/evp.h>
-#include <openssl/md5.h>
+#include <vector>
 
 template<> void DbQueryJob<AuthServer::DB_AccountData>::init(DbConnectionPool* dbConnectionPool) {
 	createBinding(dbConnectionPool,
@@ -30,52 +35,78 @@ DECLARE_DB_BINDING(AuthServer::DB_AccountData, "db_account");
 
 namespace AuthServer {
 
-std::unique_ptr<DesPasswordCipher> DB_Account::desCipher;
-std::string DB_Account::currentDesKey;
+cval<std::string>* DB_Account::desKey = nullptr;
 cval<bool>* DB_Account::restrictCharacters = nullptr;
 
 void DB_Account::init(cval<std::string>& desKeyStr) {
-	currentDesKey = desKeyStr.get();
-	desCipher.reset(new DesPasswordCipher(desKeyStr.get().c_str()));
+	desKey = &desKeyStr;
 	restrictCharacters = &(CFG_CREATE("auth.clients.restrictchars", true));
 }
 
 void DB_Account::deinit() {
-	// delete desCipher;
-	// currentDesKey = "";
+	desKey = nullptr;
 	restrictCharacters = nullptr;
 }
 
-DB_Account::DB_Account(ClientSession* clientInfo, DbCallback callback) : DbQueryJobCallback(clientInfo, callback) {}
+// DesPasswordCipher is not thread safe, each DB thread has its own instance
+// The key is copied only when auth.clients.des_key changes
+DesPasswordCipher* DB_Account::getDesCipher() {
+	static const std::string noKey;
+	thread_local std::unique_ptr<DesPasswordCipher> desCipher;
+	thread_local std::string currentDesKey;
+	const std::string& key = desKey ? desKey->get() : noKey;
+
+	if(!desCipher || currentDesKey != key) {
+		desCipher.reset(new DesPasswordCipher(key.c_str()));
+		currentDesKey = key;
+	}
+
+	return desCipher.get();
+}
+
+// The salt is processed again only when auth.db.salt changes
+const SaltedMd5& DB_Account::getPasswordHasher() {
+	thread_local SaltedMd5 hasher;
+	const std::string& salt = CONFIG_GET()->auth.db.salt.get();
+
+	if(hasher.getSalt() != salt)
+		hasher.setSalt(salt);
+
+	return hasher;
+}
+
+DB_Account::DB_Account(ClientSession* clientInfo, DbCallback callback)
+    : DbQueryJobCallback(clientInfo, callback), dbJob(DbJobStats::B_Account) {}
 
-bool DB_Account::decryptPassword() {
-	char password[64 + 16];
+bool DB_Account::decryptPassword(const DB_AccountData::Input* input, char password[MAX_PASSWORD_SIZE]) {
 	bool ok = false;
-	DB_AccountData::Input* input = getInput();
 
 	if(input->cryptMode == DB_AccountData::EM_AES) {
-		std::unique_ptr<EVP_CIPHER_CTX, void (*)(EVP_CIPHER_CTX*)> d_ctx(nullptr, &EVP_CIPHER_CTX_free);
+		EVP_CIPHER_CTX* d_ctx;
 		int bytesWritten, totalLength;
 		unsigned int bytesRead;
 
-		log(LL_Debug, "Client login using AES\n");
+		logStatic(LL_Debug, getStaticClassName(), "Client login using AES\n");
 
 		// if crypted size is > max size - 128 bits, then the decrypted password will overflow in the destination
 		// variable
-		if(input->cryptedPassword.size() > sizeof(password) - 16) {
-			log(LL_Warning, "RSA: invalid password length: %d\n", (int) input->cryptedPassword.size());
+		if(input->cryptedPassword.size() > MAX_PASSWORD_SIZE - 16) {
+			logStatic(LL_Warning,
+			          getStaticClassName(),
+			          "RSA: invalid password length: %d\n",
+			          (int) input->cryptedPassword.size());
 			return false;
 		}
 
-		d_ctx.reset(EVP_CIPHER_CTX_new());
+		d_ctx = ThreadCipherContext::get();
 		if(!d_ctx)
 			goto cleanup_aes;
 
-		if(EVP_DecryptInit_ex(d_ctx.get(), EVP_aes_128_cbc(), NULL, input->aesKey, input->aesKey + 16) <= 0)
+		if(EVP_DecryptInit_ex(d_ctx, EVP_aes_128_cbc(), NULL, input->aesKey, input->aesKey + 16) <= 0)
 			goto cleanup_aes;
 
 		for(totalLength = bytesRead = 0; bytesRead + 15 < input->cryptedPassword.size(); bytesRead += 16) {
-			if(EVP_DecryptUpdate(d_ctx.get(),
+			if(EVP_DecryptUpdate(d_ctx,
 			                     (unsigned char*) password + totalLength,
 			                     &bytesWritten,
 			                     &input->cryptedPassword[0] + bytesRead,
@@ -84,13 +115,17 @@ bool DB_Account::decryptPassword() {
 			totalLength += bytesWritten;
 		}
 
-		if(EVP_DecryptFinal_ex(d_ctx.get(), (unsigned char*) password + totalLength, &bytesWritten) <= 0)
+		if(EVP_DecryptFinal_ex(d_ctx, (unsigned char*) password + totalLength, &bytesWritten) <= 0)
 			goto cleanup_aes;
 
 		totalLength += bytesWritten;
 
-		if(totalLength >= (int) sizeof(password)) {
-			log(LL_Error, "Password length overflow: %d >= %d\n", totalLength, (int) sizeof(password));
+		if(totalLength >= (int) MAX_PASSWORD_SIZE) {
+			logStatic(LL_Error,
+			          getStaticClassName(),
+			          "Password length overflow: %d >= %d\n",
+			          totalLength,
+			          (int) MAX_PASSWORD_SIZE);
 			goto cleanup_aes;
 		}
 
@@ -99,73 +134,53 @@ bool DB_Account::decryptPassword() {
 
 	cleanup_aes:
 		unsigned long errorCode = ERR_get_error();
-		if(errorCode)
-			log(LL_Warning,
-			    "AES: error while processing password for account %s: %s\n",
-			    input->account.c_str(),
-			    ERR_error_string(errorCode, nullptr));
+		if(errorCode) {
+			// ERR_error_string with a null buffer is not thread safe
+			char errorString[256];
+
+			ERR_error_string_n(errorCode, errorString, sizeof(errorString));
+			logStatic(LL_Warning,
+			          getStaticClassName(),
+			          "AES: error while processing password for account %s: %s\n",
+			          input->account.c_str(),
+			          errorString);
+		}
 	} else if(input->cryptMode == DB_AccountData::EM_None) {
-		if(input->cryptedPassword.size() >= sizeof(password)) {
-			log(LL_Error,
-			    "Password length overflow: %d >= %d\n",
-			    (int) input->cryptedPassword.size(),
-			    (int) sizeof(password));
+		if(input->cryptedPassword.size() >= MAX_PASSWORD_SIZE) {
+			logStatic(LL_Error,
+			          getStaticClassName(),
+			          "Password length overflow: %d >= %d\n",
+			          (int) input->cryptedPassword.size(),
+			          (int) MAX_PASSWORD_SIZE);
 		} else {
 			memcpy(password, (char*) &input->cryptedPassword[0], input->cryptedPassword.size());
 			password[input->cryptedPassword.size()] = 0;
 
-			log(LL_Debug, "Client login using clear text\n");
+			logStatic(LL_Debug, getStaticClassName(), "Client login using clear text\n");
 
 			ok = true;
 		}
 	} else {
-		if(input->cryptedPassword.size() >= sizeof(password)) {
-			log(LL_Error,
-			    "Password length overflow: %d >= %d\n",
-			    (int) input->cryptedPassword.size(),
-			    (int) sizeof(password));
+		if(input->cryptedPassword.size() >= MAX_PASSWORD_SIZE) {
+			logStatic(LL_Error,
+			          getStaticClassName(),
+			          "Password length overflow: %d >= %d\n",
+			          (int) input->cryptedPassword.size(),
+			          (int) MAX_PASSWORD_SIZE);
 		} else {
 			memcpy(password, (char*) &input->cryptedPassword[0], input->cryptedPassword.size());
 
-			log(LL_Debug, "Client login using DES\n");
-			desCipher->decrypt(password, (int) input->cryptedPassword.size());
+			logStatic(LL_Debug, getStaticClassName(), "Client login using DES\n");
+			getDesCipher()->decrypt(password, (int) input->cryptedPassword.size());
 			password[input->cryptedPassword.size()] = 0;
 
 			ok = true;
 		}
 	}
 
-	if(ok == true) {
-		unsigned char givenPasswordMd5[16];
-		std::string buffer = CONFIG_GET()->auth.db.salt;
-
-		buffer.append(password, password + strlen(password));
-		MD5((const unsigned char*) buffer.c_str(), buffer.size(), givenPasswordMd5);
-		setPasswordMD5(givenPasswordMd5);
-	}
-
 	return ok;
 }
 
-void DB_Account::setPasswordMD5(unsigned char givenPasswordMd5[16]) {
-	DB_AccountData::Input* input = getInput();
-
-	for(int i = 0; i < 16; i++) {
-		unsigned char val = givenPasswordMd5[i] >> 4;
-		if(val < 10)
-			input->password[i * 2] = val + '0';
-		else
-			input->password[i * 2] = val - 10 + 'a';
-
-		val = givenPasswordMd5[i] & 0x0F;
-		if(val < 10)
-			input->password[i * 2 + 1] = val + '0';
-		else
-			input->password[i * 2 + 1] = val - 10 + 'a';
-	}
-	input->password[32] = '\0';
-}
-
 bool DB_Account::isAccountNameValid(const std::string& account) {
 	if(account.size() == 0)
 		return false;
@@ -180,45 +195,134 @@ bool DB_Account::isAccountNameValid(const std::string& account) {
 	return true;
 }
 
-bool DB_Account::onPreProcess() {
-	DB_AccountData::Input* input = getInput();
-
+bool DB_Account::checkAccountName(const DB_AccountData::Input* input) {
 	// Accounts with invalid names are refused
 	if(restrictCharacters && restrictCharacters->get() && !isAccountNameValid(input->account)) {
-		log(LL_Debug, "Account name has invalid character: %s\n", input->account.c_str());
+		logStatic(LL_Debug, getStaticClassName(), "Account name has invalid character: %s\n", input->account.c_str());
 		return false;
 	}
 
-	if(decryptPassword() == false)
+	return true;
+}
+
+bool DB_Account::preProcessInput(DB_AccountData::Input* input) {
+	char password[MAX_PASSWORD_SIZE];
+	unsigned char passwordMd5[SaltedMd5::DIGEST_SIZE];
+
+	if(checkAccountName(input) == false || decryptPassword(input, password) == false)
 		return false;
 
-	log(LL_Trace, "Querying for account \"%s\" and password MD5 \"%s\"\n", input->account.c_str(), input->password);
+	getPasswordHasher().hash(password, strlen(password), passwordMd5);
+	SaltedMd5::toHex(passwordMd5, input->password);
+
+	logStatic(LL_Trace,
+	          getStaticClassName(),
+	          "Querying for account \"%s\" and password MD5 \"%s\"\n",
+	          input->account.c_str(),
+	          input->password);
 
 	return true;
 }
 
-bool DB_Account::onRowDone() {
-	const DB_AccountData::Input* input = getInput();
-	DB_AccountData::Output* output = getResults().back().get();
+void DB_Account::preProcessInputs(DB_AccountData::Input* const* inputs, bool* valid, size_t count) {
+	std::unique_ptr<char[][MAX_PASSWORD_SIZE]> passwords(new char[count][MAX_PASSWORD_SIZE]);
+	std::unique_ptr<unsigned char[][SaltedMd5::DIGEST_SIZE]> passwordMd5s(
+	    new unsigned char[count][SaltedMd5::DIGEST_SIZE]);
+	std::vector<const void*> passwordData;
+	std::vector<size_t> passwordSizes;
+	std::vector<DB_AccountData::Input*> hashedInputs;
+
+	passwordData.reserve(count);
+	passwordSizes.reserve(count);
+	hashedInputs.reserve(count);
+
+	for(size_t i = 0; i < count; i++) {
+		valid[i] = checkAccountName(inputs[i]) && decryptPassword(inputs[i], passwords[i]);
+		if(valid[i]) {
+			passwordData.push_back(passwords[i]);
+			passwordSizes.push_back(strlen(passwords[i]));
+			hashedInputs.push_back(inputs[i]);
+		}
+	}
 
-	if(output->account_id == 0xFFFFFFFF) {
-		log(LL_Trace, "Account %s not found in database\n", input->account.c_str());
-		return false;
+	// All passwords are hashed together so SaltedMd5 can use SIMD lanes
+	getPasswordHasher().hashMultiple(passwordData.data(), passwordSizes.data(), passwordMd5s.get(), hashedInputs.size());
+
+	for(size_t i = 0; i < hashedInputs.size(); i++) {
+		SaltedMd5::toHex(passwordMd5s[i], hashedInputs[i]->password);
+
+		logStatic(LL_Trace,
+		          getStaticClassName(),
+		          "Querying for account \"%s\" and password MD5 \"%s\"\n",
+		          hashedInputs[i]->account.c_str(),
+		          hashedInputs[i]->password);
 	}
+}
 
+void DB_Account::checkPassword(const DB_AccountData::Input* input, DB_AccountData::Output* output) {
 	if(output->nullPassword == true && output->password[0] == '\0') {
 		output->ok = true;
 	} else if(!strcmp(input->password, output->password)) {
 		output->ok = true;
 	} else {
-		log(LL_Trace,
-		    "Password mismatch for account \"%s\": client tried \"%s\", database has \"%s\"\n",
-		    input->account.c_str(),
-		    input->password,
-		    output->password);
+		logStatic(LL_Trace,
+		          getStaticClassName(),
+		          "Password mismatch for account \"%s\": client tried \"%s\", database has \"%s\"\n",
+		          input->account.c_str(),
+		          input->password,
+		          output->password);
+	}
+}
+
+bool DB_Account::onPreProcess() {
+	DB_AccountData::Input* input = getInput();
+	DB_AccountData::Output cachedOutput;
+	bool ok;
+
+	dbJob.onStart();
+	LoginTracer::record(input->traceId, LTS_AccountQueue, LTE_End);
+	LoginTracer::record(input->traceId, LTS_AccountPreProcess, LTE_Begin);
+	ok = preProcessInput(input);
+	LoginTracer::record(input->traceId, LTS_AccountPreProcess, LTE_End);
+
+	if(ok == false)
+		return false;
+
+	// No DB query needed, the result is directly given to the session
+	if(AccountCache::get()->getAccount(input, &cachedOutput)) {
+		log(LL_Trace, "Account \"%s\" found in cache\n", input->account.c_str());
+		getResults().emplace_back(new DB_AccountData::Output(cachedOutput));
+		return false;
+	}
+
+	LoginTracer::record(input->traceId, LTS_DbExecute, LTE_Begin);
+
+	return true;
+}
+
+bool DB_Account::onRowDone() {
+	const DB_AccountData::Input* input = getInput();
+	DB_AccountData::Output* output = getResults().back().get();
+
+	LoginTracer::record(input->traceId, LTS_DbExecute, LTE_End);
+	LoginTracer::record(input->traceId, LTS_RowDone, LTE_Begin);
+
+	if(output->account_id == 0xFFFFFFFF) {
+		LoginTracer::record(input->traceId, LTS_RowDone, LTE_End);
+		log(LL_Trace, "Account %s not found in database\n", input->account.c_str());
+		return false;
 	}
 
+	checkPassword(input, output);
+	AccountCache::get()->addAccount(input, output);
+	LoginTracer::record(input->traceId, LTS_RowDone, LTE_End);
+
 	return false;
 }
 
+void DB_Account::onDone(Status status) {
+	dbJob.onDone(status == S_Ok, status == S_Canceled);
+	DbQueryJobCallback::onDone(status);
+}
+
 }  // namespace AuthServer
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Database/DbQueryJobRef.h"
+#include "DbJobStats.h"
 #include "Stream/StreamAddress.h"
 #include <stdint.h>
 #include <string.h>
@@ -8,6 +9,7 @@
 
 class DbConnectionPool;
 class DesPasswordCipher;
+class SaltedMd5;
 
 namespace AuthServer {
 
@@ -22,17 +24,18 @@ struct DB_AccountData {
 		std::vector<unsigned char> cryptedPassword;
 		EncryptMode cryptMode;
 		unsigned char aesKey[32];
+		uint32_t traceId;  // See LoginTracer
 
 		// Computed in preProcess()
 		char password[33];
 
-		Input() {}
+		Input() : traceId(0) {}
 		Input(const std::string& account,
 		      const StreamAddress& ip,
 		      EncryptMode cryptMode,
 		      const std::vector<unsigned char>& cryptedPassword,
 		      unsigned char aesKey[32])
-		    : account(account), cryptedPassword(cryptedPassword), cryptMode(cryptMode) {
+		    : account(account), cryptedPassword(cryptedPassword), cryptMode(cryptMode), traceId(0) {
 			ip.getName(this->ip, sizeof(this->ip));
 
 			memcpy(this->aesKey, aesKey, sizeof(this->aesKey));
@@ -76,17 +79,32 @@ public:
 
 	DB_Account(ClientSession* clientInfo, DbQueryJobCallback::DbCallback callback);
 
+	// Shared with batched account queries (DB_AccountBatch), called in DB threads
+	// Check the account name and compute input->password, return false if the account must be refused
+	static bool preProcessInput(DB_AccountData::Input* input);
+	// Same as preProcessInput for several accounts, valid[i] is set to the result for inputs[i]
+	static void preProcessInputs(DB_AccountData::Input* const* inputs, bool* valid, size_t count);
+	// Set output->ok if the password match
+	static void checkPassword(const DB_AccountData::Input* input, DB_AccountData::Output* output);
+
 protected:
 	bool onPreProcess();
 	bool onRowDone();
-	bool isAccountNameValid(const std::string& account);
-	bool decryptPassword();
-	void setPasswordMD5(unsigned char givenPasswordMd5[16]);
+	void onDone(Status status);
+	static const size_t MAX_PASSWORD_SIZE = 64 + 16;
+
+	static bool isAccountNameValid(const std::string& account);
+	static bool checkAccountName(const DB_AccountData::Input* input);
+	// Decrypt the password sent by the client, password is null terminated
+	static bool decryptPassword(const DB_AccountData::Input* input, char password[MAX_PASSWORD_SIZE]);
+	static DesPasswordCipher* getDesCipher();
+	static const SaltedMd5& getPasswordHasher();
 
 private:
-	static std::unique_ptr<DesPasswordCipher> desCipher;  // cached DES cipher
-	static std::string currentDesKey;
+	static cval<std::string>* desKey;
 	static cval<bool>* restrictCharacters;
+
+	DbJobTracker dbJob;
 };
 
 }  // namespace AuthServer
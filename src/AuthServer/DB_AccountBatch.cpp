@@ -0,0 +1,152 @@
+#include "DB_AccountBatch.h"
+#include "../GlobalConfig.h"
+#include "AccountBatcher.h"
+#include "AccountCache.h"
+#include "LoginTracer.h"
+#include <ctype.h>
+
+template<> void DbQueryJob<AuthServer::DB_AccountBatchData>::init(DbConnectionPool* dbConnectionPool) {
+	createBinding(dbConnectionPool,
+	              CONFIG_GET()->auth.db.connectionString,
+	              "SELECT * FROM account WHERE (account = ? AND password = ?) OR (account = ? AND password = ?)"
+	              " OR (account = ? AND password = ?) OR (account = ? AND password = ?)"
+	              " OR (account = ? AND password = ?) OR (account = ? AND password = ?)"
+	              " OR (account = ? AND password = ?) OR (account = ? AND password = ?);",
+	              DbQueryBinding::EM_MultiRows);
+
+	addParam("account0", &InputType::account0);
+	addParam("password0", &InputType::password0);
+	addParam("account1", &InputType::account1);
+	addParam("password1", &InputType::password1);
+	addParam("account2", &InputType::account2);
+	addParam("password2", &InputType::password2);
+	addParam("account3", &InputType::account3);
+	addParam("password3", &InputType::password3);
+	addParam("account4", &InputType::account4);
+	addParam("password4", &InputType::password4);
+	addParam("account5", &InputType::account5);
+	addParam("password5", &InputType::password5);
+	addParam("account6", &InputType::account6);
+	addParam("password6", &InputType::password6);
+	addParam("account7", &InputType::account7);
+	addParam("password7", &InputType::password7);
+
+	addColumn("account", &OutputType::account);
+	addColumn("account_id", &OutputType::account_id);
+	addColumn("password", &OutputType::password, &OutputType::nullPassword);
+	addColumn("auth_ok", &OutputType::auth_ok);
+	addColumn("age", &OutputType::age);
+	addColumn("last_login_server_idx", &OutputType::last_login_server_idx);
+	addColumn("event_code", &OutputType::event_code);
+	addColumn("pcbang", &OutputType::pcbang);
+	addColumn("server_idx_offset", &OutputType::server_idx_offset);
+	addColumn("block", &OutputType::block);
+}
+DECLARE_DB_BINDING(AuthServer::DB_AccountBatchData, "db_accountbatch");
+
+namespace AuthServer {
+
+// Account names are case insensitive in the database
+static bool isSameAccount(const char* account1, const std::string& account2) {
+	size_t i;
+
+	for(i = 0; account1[i] && i < account2.size(); i++) {
+		if(tolower((unsigned char) account1[i]) != tolower((unsigned char) account2[i]))
+			return false;
+	}
+
+	return account1[i] == '\0' && i == account2.size();
+}
+
+DB_AccountBatch::DB_AccountBatch(AccountBatch* batch, DbCallback callback)
+    : DbQueryJobCallback(batch, callback), dbJob(DbJobStats::B_AccountBatch) {}
+
+bool DB_AccountBatch::onPreProcess() {
+	DB_AccountBatchData::Input* input = getInput();
+	std::string* accountParams[] = {&input->account0,
+	                                &input->account1,
+	                                &input->account2,
+	                                &input->account3,
+	                                &input->account4,
+	                                &input->account5,
+	                                &input->account6,
+	                                &input->account7};
+	std::string* passwordParams[] = {&input->password0,
+	                                 &input->password1,
+	                                 &input->password2,
+	                                 &input->password3,
+	                                 &input->password4,
+	                                 &input->password5,
+	                                 &input->password6,
+	                                 &input->password7};
+	DB_AccountData::Input* accounts[DB_AccountBatchData::MAX_ACCOUNTS];
+	bool validAccounts[DB_AccountBatchData::MAX_ACCOUNTS];
+	size_t accountCount = input->accounts.size();
+	size_t paramCount = 0;
+
+	dbJob.onStart();
+	input->states.assign(input->accounts.size(), DB_AccountBatchData::AS_Refused);
+	input->cachedAccounts.resize(input->accounts.size());
+
+	if(accountCount > DB_AccountBatchData::MAX_ACCOUNTS)
+		accountCount = DB_AccountBatchData::MAX_ACCOUNTS;
+	for(size_t i = 0; i < accountCount; i++) {
+		accounts[i] = &input->accounts[i];
+		LoginTracer::record(accounts[i]->traceId, LTS_AccountQueue, LTE_End);
+		LoginTracer::record(accounts[i]->traceId, LTS_AccountPreProcess, LTE_Begin);
+	}
+	DB_Account::preProcessInputs(accounts, validAccounts, accountCount);
+
+	for(size_t i = 0; i < accountCount; i++) {
+		LoginTracer::record(accounts[i]->traceId, LTS_AccountPreProcess, LTE_End);
+		if(!validAccounts[i])
+			continue;
+
+		if(AccountCache::get()->getAccount(&input->accounts[i], &input->cachedAccounts[i])) {
+			input->states[i] = DB_AccountBatchData::AS_Cached;
+		} else {
+			input->states[i] = DB_AccountBatchData::AS_Queried;
+			*accountParams[paramCount] = input->accounts[i].account;
+			*passwordParams[paramCount] = input->accounts[i].password;
+			paramCount++;
+			LoginTracer::record(accounts[i]->traceId, LTS_DbExecute, LTE_Begin);
+		}
+	}
+
+	// All accounts were refused or cached, no need to query the DB
+	if(paramCount == 0)
+		return false;
+
+	for(size_t i = paramCount; i < DB_AccountBatchData::MAX_ACCOUNTS; i++) {
+		*accountParams[i] = *accountParams[0];
+		*passwordParams[i] = *passwordParams[0];
+	}
+
+	log(LL_Trace, "Querying %d accounts\n", (int) paramCount);
+
+	return true;
+}
+
+const DB_AccountBatchData::Output* DB_AccountBatch::findAccount(const std::string& account) {
+	auto& results = getResults();
+	const DB_AccountBatchData::Output* accountRow = nullptr;
+
+	for(size_t i = 0; i < results.size(); i++) {
+		if(!isSameAccount(results[i]->account, account))
+			continue;
+
+		// Like the non batched query, only one account must match
+		if(accountRow)
+			return nullptr;
+		accountRow = results[i].get();
+	}
+
+	return accountRow;
+}
+
+void DB_AccountBatch::onDone(Status status) {
+	dbJob.onDone(status == S_Ok, status == S_Canceled);
+	DbQueryJobCallback::onDone(status);
+}
+
+}  // namespace AuthServer
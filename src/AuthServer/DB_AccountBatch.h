@@ -0,0 +1,97 @@
+#pragma once
+
+#include "DB_Account.h"
+#include "Database/DbQueryJobRef.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace AuthServer {
+
+class AccountBatch;
+
+// Lookup of several accounts with one query, see AccountBatcher
+// Like DB_Account, each account is matched with its password in the query
+struct DB_AccountBatchData {
+	static const size_t MAX_ACCOUNTS = 8;
+
+	enum AccountState {
+		AS_Refused,  // Refused without querying the DB (invalid name or password)
+		AS_Queried,
+		AS_Cached  // Found in AccountCache
+	};
+
+	struct Input {
+		// Batched logins, password is computed in preProcess()
+		std::vector<DB_AccountData::Input> accounts;
+		// Set in preProcess()
+		std::vector<AccountState> states;
+		std::vector<DB_AccountData::Output> cachedAccounts;
+
+		// Query parameters, unused ones are set to the first queried account and password
+		std::string account0;
+		std::string password0;
+		std::string account1;
+		std::string password1;
+		std::string account2;
+		std::string password2;
+		std::string account3;
+		std::string password3;
+		std::string account4;
+		std::string password4;
+		std::string account5;
+		std::string password5;
+		std::string account6;
+		std::string password6;
+		std::string account7;
+		std::string password7;
+	};
+
+	struct Output {
+		char account[61];
+		uint32_t account_id;
+		char password[35];
+		bool nullPassword;
+		bool auth_ok;
+		uint32_t age;
+		uint16_t last_login_server_idx;
+		uint32_t event_code;
+		uint32_t pcbang;
+		uint32_t server_idx_offset;
+		bool block;
+
+		Output() {
+			DB_AccountData::Output defaultValues;
+
+			account[0] = '\0';
+			password[0] = '\0';
+			account_id = defaultValues.account_id;
+			nullPassword = defaultValues.nullPassword;
+			auth_ok = defaultValues.auth_ok;
+			age = defaultValues.age;
+			last_login_server_idx = defaultValues.last_login_server_idx;
+			event_code = defaultValues.event_code;
+			pcbang = defaultValues.pcbang;
+			server_idx_offset = defaultValues.server_idx_offset;
+			block = defaultValues.block;
+		}
+	};
+};
+
+class DB_AccountBatch : public DbQueryJobCallback<DB_AccountBatchData, AccountBatch, DB_AccountBatch> {
+	DECLARE_CLASS(AuthServer::DB_AccountBatch)
+public:
+	DB_AccountBatch(AccountBatch* batch, DbQueryJobCallback::DbCallback callback);
+
+	// Return the row of the given account or null if not found
+	const DB_AccountBatchData::Output* findAccount(const std::string& account);
+
+protected:
+	bool onPreProcess();
+	void onDone(Status status);
+
+private:
+	DbJobTracker dbJob;
+};
+
+}  // namespace AuthServer
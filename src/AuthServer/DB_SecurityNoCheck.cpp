@@ -1,10 +1,10 @@
 #include "DB_SecurityNoCheck.h"
 #include "../GlobalConfig.h"
+#include "../SaltedMd5.h"
 #include "ClientSession.h"
 #include "Core/EventLoop.h"
 #include "Database/DbConnectionPool.h"
 #include "GameServerSession.h"
-#include <openssl/md5.h>
 #include <sql.h>
 #include <sqlext.h>
 #include <stdio.h>
@@ -34,42 +34,33 @@ void DB_SecurityNoCheck::deinit() {
 }
 
 DB_SecurityNoCheck::DB_SecurityNoCheck(GameServerSession* clientInfo, DbCallback callback)
-    : DbQueryJobCallback(clientInfo, callback) {}
+    : DbQueryJobCallback(clientInfo, callback), dbJob(DbJobStats::B_SecurityNoCheck) {}
 
 bool DB_SecurityNoCheck::onPreProcess() {
+	dbJob.onStart();
+
 	if(!securityNoSalt) {
 		log(LL_Warning, "Security No config not bound ! Can\'t check security no\n");
 		return false;
 	}
 
-	unsigned char securityNoMd5[16];
-	std::string buffer = securityNoSalt->get();
+	thread_local SaltedMd5 hasher;
+	unsigned char securityNoMd5[SaltedMd5::DIGEST_SIZE];
+	const std::string& salt = securityNoSalt->get();
 	DB_SecurityNoCheckData::Input* input = getInput();
 
-	buffer += input->securityNo;
-	MD5((const unsigned char*) buffer.c_str(), buffer.size(), securityNoMd5);
-	setPasswordMD5(securityNoMd5);
+	if(hasher.getSalt() != salt)
+		hasher.setSalt(salt);
+
+	hasher.hash(input->securityNo.c_str(), input->securityNo.size(), securityNoMd5);
+	SaltedMd5::toHex(securityNoMd5, input->securityNoMd5String);
 
 	return true;
 }
 
-void DB_SecurityNoCheck::setPasswordMD5(unsigned char securityNoMd5[16]) {
-	DB_SecurityNoCheckData::Input* input = getInput();
-
-	for(int i = 0; i < 16; i++) {
-		unsigned char val = securityNoMd5[i] >> 4;
-		if(val < 10)
-			input->securityNoMd5String[i * 2] = val + '0';
-		else
-			input->securityNoMd5String[i * 2] = val - 10 + 'a';
-
-		val = securityNoMd5[i] & 0x0F;
-		if(val < 10)
-			input->securityNoMd5String[i * 2 + 1] = val + '0';
-		else
-			input->securityNoMd5String[i * 2 + 1] = val - 10 + 'a';
-	}
-	input->securityNoMd5String[32] = '\0';
+void DB_SecurityNoCheck::onDone(Status status) {
+	dbJob.onDone(status == S_Ok, status == S_Canceled);
+	DbQueryJobCallback::onDone(status);
 }
 
 }  // namespace AuthServer
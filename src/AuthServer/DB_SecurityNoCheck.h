@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Database/DbQueryJobRef.h"
+#include "DbJobStats.h"
 #include "uv.h"
 #include <stdint.h>
 
@@ -16,10 +17,11 @@ struct DB_SecurityNoCheckData {
 		std::string securityNo;
 		int32_t mode;
 		char securityNoMd5String[33];
+		uint64_t requestTime;  // When the request packet was received, for PacketLatency
 
-		Input() {}
+		Input() : requestTime(0) {}
 		Input(std::string account, std::string securityNo, int32_t mode)
-		    : account(account), securityNo(securityNo), mode(mode) {}
+		    : account(account), securityNo(securityNo), mode(mode), requestTime(0) {}
 	};
 
 	struct Output {};
@@ -37,10 +39,12 @@ public:
 	bool onPreProcess();
 
 protected:
-	void setPasswordMD5(unsigned char securityNoMd5[16]);
+	void onDone(Status status);
 
 private:
 	static cval<std::string>* securityNoSalt;
+
+	DbJobTracker dbJob;
 };
 
 }  // namespace AuthServer
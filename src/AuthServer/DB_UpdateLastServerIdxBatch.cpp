@@ -0,0 +1,99 @@
+#include "DB_UpdateLastServerIdxBatch.h"
+#include "../GlobalConfig.h"
+#include "LastServerIdxUpdater.h"
+
+template<> void DbQueryJob<AuthServer::DB_UpdateLastServerIdxBatchData>::init(DbConnectionPool* dbConnectionPool) {
+	createBinding(dbConnectionPool,
+	              CONFIG_GET()->auth.db.connectionString,
+	              "UPDATE account SET last_login_server_idx = CASE account_id"
+	              " WHEN ? THEN ? WHEN ? THEN ? WHEN ? THEN ? WHEN ? THEN ?"
+	              " WHEN ? THEN ? WHEN ? THEN ? WHEN ? THEN ? WHEN ? THEN ? END"
+	              " WHERE account_id IN (?, ?, ?, ?, ?, ?, ?, ?);",
+	              DbQueryBinding::EM_NoRow);
+
+	addParam("accountid0", &InputType::accountId0);
+	addParam("serveridx0", &InputType::serverIdx0);
+	addParam("accountid1", &InputType::accountId1);
+	addParam("serveridx1", &InputType::serverIdx1);
+	addParam("accountid2", &InputType::accountId2);
+	addParam("serveridx2", &InputType::serverIdx2);
+	addParam("accountid3", &InputType::accountId3);
+	addParam("serveridx3", &InputType::serverIdx3);
+	addParam("accountid4", &InputType::accountId4);
+	addParam("serveridx4", &InputType::serverIdx4);
+	addParam("accountid5", &InputType::accountId5);
+	addParam("serveridx5", &InputType::serverIdx5);
+	addParam("accountid6", &InputType::accountId6);
+	addParam("serveridx6", &InputType::serverIdx6);
+	addParam("accountid7", &InputType::accountId7);
+	addParam("serveridx7", &InputType::serverIdx7);
+	addParam("whereaccountid0", &InputType::whereAccountId0);
+	addParam("whereaccountid1", &InputType::whereAccountId1);
+	addParam("whereaccountid2", &InputType::whereAccountId2);
+	addParam("whereaccountid3", &InputType::whereAccountId3);
+	addParam("whereaccountid4", &InputType::whereAccountId4);
+	addParam("whereaccountid5", &InputType::whereAccountId5);
+	addParam("whereaccountid6", &InputType::whereAccountId6);
+	addParam("whereaccountid7", &InputType::whereAccountId7);
+}
+DECLARE_DB_BINDING(AuthServer::DB_UpdateLastServerIdxBatchData, "db_updatelastserveridxbatch");
+
+namespace AuthServer {
+
+DB_UpdateLastServerIdxBatch::DB_UpdateLastServerIdxBatch(LastServerIdxUpdater* updater, DbCallback callback)
+    : DbQueryJobCallback(updater, callback), dbJob(DbJobStats::B_UpdateLastServerIdxBatch) {}
+
+bool DB_UpdateLastServerIdxBatch::onPreProcess() {
+	DB_UpdateLastServerIdxBatchData::Input* input = getInput();
+	uint32_t* accountIds[] = {&input->accountId0,
+	                          &input->accountId1,
+	                          &input->accountId2,
+	                          &input->accountId3,
+	                          &input->accountId4,
+	                          &input->accountId5,
+	                          &input->accountId6,
+	                          &input->accountId7};
+	uint16_t* serverIdxs[] = {&input->serverIdx0,
+	                          &input->serverIdx1,
+	                          &input->serverIdx2,
+	                          &input->serverIdx3,
+	                          &input->serverIdx4,
+	                          &input->serverIdx5,
+	                          &input->serverIdx6,
+	                          &input->serverIdx7};
+	uint32_t* whereAccountIds[] = {&input->whereAccountId0,
+	                               &input->whereAccountId1,
+	                               &input->whereAccountId2,
+	                               &input->whereAccountId3,
+	                               &input->whereAccountId4,
+	                               &input->whereAccountId5,
+	                               &input->whereAccountId6,
+	                               &input->whereAccountId7};
+	size_t updateCount = input->updates.size();
+
+	dbJob.onStart();
+	if(updateCount == 0)
+		return false;
+	if(updateCount > DB_UpdateLastServerIdxBatchData::MAX_UPDATES)
+		updateCount = DB_UpdateLastServerIdxBatchData::MAX_UPDATES;
+
+	for(size_t i = 0; i < DB_UpdateLastServerIdxBatchData::MAX_UPDATES; i++) {
+		// Repeating the first update doesn't change the result
+		const DB_UpdateLastServerIdxBatchData::Update& update = input->updates[i < updateCount ? i : 0];
+
+		*accountIds[i] = update.accountId;
+		*serverIdxs[i] = update.lastLoginServerIdx;
+		*whereAccountIds[i] = update.accountId;
+	}
+
+	log(LL_Trace, "Updating last server of %d accounts\n", (int) updateCount);
+
+	return true;
+}
+
+void DB_UpdateLastServerIdxBatch::onDone(Status status) {
+	dbJob.onDone(status == S_Ok, status == S_Canceled);
+	DbQueryJobCallback::onDone(status);
+}
+
+}  // namespace AuthServer
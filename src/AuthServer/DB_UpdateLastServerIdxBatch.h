@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Database/DbQueryJobRef.h"
+#include "DbJobStats.h"
+#include <stdint.h>
+#include <vector>
+
+namespace AuthServer {
+
+class LastServerIdxUpdater;
+
+// Update of the last selected game server of several accounts with one query, see LastServerIdxUpdater
+struct DB_UpdateLastServerIdxBatchData {
+	static const size_t MAX_UPDATES = 8;
+
+	struct Update {
+		uint32_t accountId;
+		uint16_t lastLoginServerIdx;
+	};
+
+	struct Input {
+		// Updates of different accounts, query parameters are set from them in preProcess()
+		std::vector<Update> updates;
+		uint64_t flushTime;
+
+		// Query parameters, unused ones are set to an already used update
+		uint32_t accountId0;
+		uint32_t accountId1;
+		uint32_t accountId2;
+		uint32_t accountId3;
+		uint32_t accountId4;
+		uint32_t accountId5;
+		uint32_t accountId6;
+		uint32_t accountId7;
+		uint16_t serverIdx0;
+		uint16_t serverIdx1;
+		uint16_t serverIdx2;
+		uint16_t serverIdx3;
+		uint16_t serverIdx4;
+		uint16_t serverIdx5;
+		uint16_t serverIdx6;
+		uint16_t serverIdx7;
+		uint32_t whereAccountId0;
+		uint32_t whereAccountId1;
+		uint32_t whereAccountId2;
+		uint32_t whereAccountId3;
+		uint32_t whereAccountId4;
+		uint32_t whereAccountId5;
+		uint32_t whereAccountId6;
+		uint32_t whereAccountId7;
+	};
+
+	struct Output {};
+};
+
+class DB_UpdateLastServerIdxBatch
+    : public DbQueryJobCallback<DB_UpdateLastServerIdxBatchData, LastServerIdxUpdater, DB_UpdateLastServerIdxBatch> {
+	DECLARE_CLASS(AuthServer::DB_UpdateLastServerIdxBatch)
+public:
+	DB_UpdateLastServerIdxBatch(LastServerIdxUpdater* updater, DbQueryJobCallback::DbCallback callback);
+
+protected:
+	bool onPreProcess();
+	void onDone(Status status);
+
+private:
+	DbJobTracker dbJob;
+};
+
+}  // namespace AuthServer
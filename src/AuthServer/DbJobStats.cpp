@@ -0,0 +1,197 @@
+#include "DbJobStats.h"
+#include "../GlobalConfig.h"
+#include "Console/ConsoleCommands.h"
+#include "Core/EventLoop.h"
+
+namespace AuthServer {
+
+void DbJobStats::init() {
+	ConsoleCommands::get()->addCommand("db.stats",
+	                                   "dbstats",
+	                                   0,
+	                                   0,
+	                                   &commandStats,
+	                                   "Show DB queries statistics",
+	                                   "db.stats : show queued, running, completed, failed and cancelled DB queries "
+	                                   "and their queue wait and execution time");
+}
+
+DbJobStats* DbJobStats::get() {
+	static DbJobStats stats;
+	return &stats;
+}
+
+DbJobStats::DbJobStats() : runningJobs(0), maxRunningJobs(0), started(false) {
+	for(size_t i = 0; i < B_Count; i++) {
+		bindings[i].queued = 0;
+		bindings[i].running = 0;
+		bindings[i].cancelled = 0;
+		bindings[i].completed = 0;
+		bindings[i].failed = 0;
+		bindings[i].intervalJobs = 0;
+	}
+	bindings[B_Account].name = "db_account";
+	bindings[B_AccountBatch].name = "db_accountbatch";
+	bindings[B_SecurityNoCheck].name = "db_securitynocheck";
+	bindings[B_UpdateLastServerIdxBatch].name = "db_updatelastserveridxbatch";
+}
+
+void DbJobStats::start() {
+	int interval = CONFIG_GET()->auth.dbStats.logInterval.get();
+
+	if(started || interval <= 0)
+		return;
+
+	uv_timer_init(EventLoop::getLoop(), &logTimer);
+	logTimer.data = this;
+	// Don't keep the event loop alive just for this
+	uv_unref((uv_handle_t*) &logTimer);
+	uv_timer_start(&logTimer, &onLogTimer, interval * 1000, interval * 1000);
+
+	started = true;
+}
+
+void DbJobStats::stop() {
+	if(!started)
+		return;
+
+	started = false;
+	uv_timer_stop(&logTimer);
+	uv_close((uv_handle_t*) &logTimer, nullptr);
+}
+
+void DbJobStats::onJobStarted() {
+	int32_t running = ++runningJobs;
+	int32_t currentMax = maxRunningJobs;
+
+	while(running > currentMax && !maxRunningJobs.compare_exchange_weak(currentMax, running)) {
+	}
+}
+
+void DbJobStats::onLogTimer(uv_timer_t* timer) {
+	DbJobStats* stats = (DbJobStats*) timer->data;
+	stats->logSummary();
+}
+
+void DbJobStats::logSummary() {
+	bool hasActivity = false;
+
+	for(size_t i = 0; i < B_Count; i++) {
+		BindingStats& binding = bindings[i];
+
+		if(binding.intervalJobs == 0 && binding.queued == 0 && binding.running == 0)
+			continue;
+
+		log(LL_Info,
+		    "%s: %llu queries done, queued: %d, running: %d, wait p50/p99: %.1f/%.1f ms, exec p50/p99: %.1f/%.1f ms\n",
+		    binding.name,
+		    (unsigned long long) binding.intervalJobs,
+		    (int) binding.queued,
+		    (int) binding.running,
+		    binding.intervalQueueWait.getPercentile(50) / 1000000.0,
+		    binding.intervalQueueWait.getPercentile(99) / 1000000.0,
+		    binding.intervalExecution.getPercentile(50) / 1000000.0,
+		    binding.intervalExecution.getPercentile(99) / 1000000.0);
+
+		binding.intervalJobs = 0;
+		binding.intervalQueueWait.reset();
+		binding.intervalExecution.reset();
+		hasActivity = true;
+	}
+
+	if(hasActivity)
+		log(LL_Info, "DB connections in use: %d, max: %d\n", (int) runningJobs, (int) maxRunningJobs);
+}
+
+void DbJobStats::commandStats(IWritableConsole* console, const std::vector<std::string>& args) {
+	DbJobStats* stats = get();
+
+	console->writef("Times in ms, wait is from the query creation to its start in a DB thread\r\n");
+	console->writef("binding                      queued running  completed     failed  cancelled"
+	                "   wait p50   wait p99   wait max   exec p50   exec p99   exec max\r\n");
+
+	for(size_t i = 0; i < B_Count; i++) {
+		const BindingStats& binding = stats->bindings[i];
+
+		console->writef("%-28s %6d %7d %10llu %10llu %10llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\r\n",
+		                binding.name,
+		                (int) binding.queued,
+		                (int) binding.running,
+		                (unsigned long long) binding.completed,
+		                (unsigned long long) binding.failed,
+		                (unsigned long long) binding.cancelled,
+		                binding.queueWait.getPercentile(50) / 1000000.0,
+		                binding.queueWait.getPercentile(99) / 1000000.0,
+		                binding.queueWait.getMax() / 1000000.0,
+		                binding.execution.getPercentile(50) / 1000000.0,
+		                binding.execution.getPercentile(99) / 1000000.0,
+		                binding.execution.getMax() / 1000000.0);
+	}
+
+	// DbConnectionPool doesn't expose its connections, a running query holds one connection
+	console->writef("DB connections in use: %d, max: %d\r\n", (int) stats->runningJobs, (int) stats->maxRunningJobs);
+}
+
+DbJobTracker::DbJobTracker(DbJobStats::Binding binding)
+    : stats(DbJobStats::get()->getBinding(binding)), createTime(uv_hrtime()), startTime(0), state(S_Queued) {
+	stats.queued++;
+}
+
+DbJobTracker::~DbJobTracker() {
+	if(state == S_Done)
+		return;
+
+	if(state == S_Queued) {
+		stats.queued--;
+	} else {
+		stats.running--;
+		DbJobStats::get()->onJobStopped();
+	}
+	stats.cancelled++;
+}
+
+void DbJobTracker::onStart() {
+	if(state != S_Queued)
+		return;
+
+	startTime = uv_hrtime();
+	state = S_Running;
+	stats.queued--;
+	stats.running++;
+	DbJobStats::get()->onJobStarted();
+}
+
+void DbJobTracker::onDone(bool ok, bool cancelled) {
+	uint64_t now = uv_hrtime();
+
+	if(state == S_Done)
+		return;
+
+	if(state == S_Queued) {
+		// Not started by a DB thread (cancelled or refused before onPreProcess)
+		stats.queued--;
+		startTime = now;
+	} else {
+		stats.running--;
+		DbJobStats::get()->onJobStopped();
+	}
+	state = S_Done;
+
+	if(cancelled) {
+		stats.cancelled++;
+		return;
+	}
+
+	if(ok)
+		stats.completed++;
+	else
+		stats.failed++;
+
+	stats.queueWait.record(startTime - createTime);
+	stats.execution.record(now - startTime);
+	stats.intervalJobs++;
+	stats.intervalQueueWait.record(startTime - createTime);
+	stats.intervalExecution.record(now - startTime);
+}
+
+}  // namespace AuthServer
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "../PacketLatency.h"
+#include "Core/Object.h"
+#include "uv.h"
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class IWritableConsole;
+
+namespace AuthServer {
+
+// Saturation of DB queries of each binding: queued, running, completed, failed and cancelled jobs with histograms of
+// the queue wait (job created -> DB thread starts it) and execution time (DB thread start -> result in the event loop).
+// Shown by db.stats and logged every auth.db.stats.loginterval seconds.
+// Jobs are counted by a DbJobTracker member of the job classes
+class DbJobStats : public Object {
+	DECLARE_CLASS(AuthServer::DbJobStats)
+
+public:
+	enum Binding { B_Account, B_AccountBatch, B_SecurityNoCheck, B_UpdateLastServerIdxBatch, B_Count };
+
+	struct BindingStats {
+		const char* name;
+
+		// Updated from DB threads
+		std::atomic<int32_t> queued;
+		std::atomic<int32_t> running;
+		std::atomic<uint64_t> cancelled;
+
+		// Updated in the event loop thread
+		uint64_t completed;
+		uint64_t failed;
+		LatencyHistogram queueWait;
+		LatencyHistogram execution;
+
+		// Since the last log summary
+		uint64_t intervalJobs;
+		LatencyHistogram intervalQueueWait;
+		LatencyHistogram intervalExecution;
+	};
+
+	static void init();
+	static DbJobStats* get();
+
+	void start();
+	void stop();
+
+	BindingStats& getBinding(Binding binding) { return bindings[binding]; }
+
+	// Running jobs hold a DB connection
+	void onJobStarted();
+	void onJobStopped() { runningJobs--; }
+
+protected:
+	static void commandStats(IWritableConsole* console, const std::vector<std::string>& args);
+
+private:
+	DbJobStats();
+
+	static void onLogTimer(uv_timer_t* timer);
+	void logSummary();
+
+	BindingStats bindings[B_Count];
+	std::atomic<int32_t> runningJobs;
+	std::atomic<int32_t> maxRunningJobs;
+
+	uv_timer_t logTimer;
+	bool started;
+};
+
+// Member of DB job classes, call onStart() in onPreProcess and onDone() in onDone.
+// Jobs deleted without onDone are counted as cancelled
+class DbJobTracker {
+public:
+	explicit DbJobTracker(DbJobStats::Binding binding);
+	~DbJobTracker();
+
+	void onStart();  // In the DB thread
+	void onDone(bool ok, bool cancelled);
+
+private:
+	enum State : uint8_t { S_Queued, S_Running, S_Done };
+
+	DbJobTracker(const DbJobTracker&) = delete;
+	DbJobTracker& operator=(const DbJobTracker&) = delete;
+
+	DbJobStats::BindingStats& stats;
+	uint64_t createTime;
+	uint64_t startTime;
+	State state;
+};
+
+}  // namespace AuthServer
@@ -0,0 +1,187 @@
+#include "DbWarmup.h"
+#include "../GlobalConfig.h"
+#include "Console/ConsoleCommands.h"
+#include "Core/EventLoop.h"
+
+namespace AuthServer {
+
+void DbWarmup::LatencyStats::add(uint64_t latency) {
+	count++;
+	total += latency;
+	if(latency > max)
+		max = latency;
+}
+
+void DbWarmup::init() {
+	ConsoleCommands::get()->addCommand("db.warmup",
+	                                   "dbwarmup",
+	                                   0,
+	                                   0,
+	                                   &commandWarm,
+	                                   "Open DB connections for login queries",
+	                                   "db.warmup : open auth.db.warmup.connections DB connections for login queries");
+	ConsoleCommands::get()->addCommand("db.warmup.stats",
+	                                   "dbwarmupstats",
+	                                   0,
+	                                   0,
+	                                   &commandStats,
+	                                   "Show DB warm-up queries latency",
+	                                   "db.warmup.stats : show cold and warm latency of DB warm-up queries");
+}
+
+DbWarmup* DbWarmup::get() {
+	static DbWarmup warmup;
+	return &warmup;
+}
+
+DbWarmup::DbWarmup() : started(false) {
+	for(size_t i = 0; i < B_Count; i++) {
+		bindings[i].roundStartTime = 0;
+		bindings[i].coldRound = true;
+	}
+	bindings[B_Account].name = "db_account";
+	bindings[B_AccountBatch].name = "db_accountbatch";
+	bindings[B_SecurityNoCheck].name = "db_securitynocheck";
+}
+
+void DbWarmup::start() {
+	if(started)
+		return;
+
+	uv_timer_init(EventLoop::getLoop(), &keepaliveTimer);
+	keepaliveTimer.data = this;
+	// Don't keep the event loop alive just for this
+	uv_unref((uv_handle_t*) &keepaliveTimer);
+
+	int keepalive = CONFIG_GET()->auth.dbWarmup.keepalive.get();
+	if(keepalive > 0)
+		uv_timer_start(&keepaliveTimer, &onKeepaliveTimer, keepalive * 1000, keepalive * 1000);
+
+	started = true;
+
+	warm(true);
+}
+
+void DbWarmup::stop() {
+	if(!started)
+		return;
+
+	uv_timer_stop(&keepaliveTimer);
+	uv_close((uv_handle_t*) &keepaliveTimer, nullptr);
+	runningQueries.clear();
+	started = false;
+}
+
+void DbWarmup::onKeepaliveTimer(uv_timer_t* timer) {
+	DbWarmup* warmup = (DbWarmup*) timer->data;
+	warmup->warm(false);
+}
+
+void DbWarmup::warm(bool cold) {
+	int connections = CONFIG_GET()->auth.dbWarmup.connections.get();
+	bool batchEnabled = CONFIG_GET()->auth.dbBatch.enable.get();
+	uint64_t now = uv_hrtime();
+
+	// Remove references to queries already done
+	for(auto it = runningQueries.begin(); it != runningQueries.end();) {
+		if(!it->inProgress())
+			it = runningQueries.erase(it);
+		else
+			++it;
+	}
+
+	for(size_t i = 0; i < B_Count; i++) {
+		bindings[i].roundStartTime = now;
+		bindings[i].coldRound = cold;
+	}
+
+	DB_AccountData::Input accountInput;
+	accountInput.ip[0] = '\0';
+	accountInput.cryptMode = DB_AccountData::EM_None;
+	accountInput.password[0] = '\0';
+
+	// No account to look up, all parameters are empty strings
+	DB_AccountBatchData::Input accountBatchInput;
+
+	DB_SecurityNoCheckData::Input securityNoInput(std::string(), std::string(), 0);
+	securityNoInput.securityNoMd5String[0] = '\0';
+
+	// Concurrent queries use different connections
+	for(int i = 0; i < connections; i++) {
+		runningQueries.emplace_back();
+		if(!runningQueries.back().executeDbQuery<DB_AccountData, DB_AccountWarmup>(
+		       this, &DbWarmup::onAccountQueryDone, accountInput))
+			runningQueries.pop_back();
+
+		// Logins use the batched query instead of db_account
+		if(batchEnabled) {
+			runningQueries.emplace_back();
+			if(!runningQueries.back().executeDbQuery<DB_AccountBatchData, DB_AccountBatchWarmup>(
+			       this, &DbWarmup::onAccountBatchQueryDone, accountBatchInput))
+				runningQueries.pop_back();
+		}
+
+		runningQueries.emplace_back();
+		if(!runningQueries.back().executeDbQuery<DB_SecurityNoCheckData, DB_SecurityNoCheckWarmup>(
+		       this, &DbWarmup::onSecurityNoCheckQueryDone, securityNoInput))
+			runningQueries.pop_back();
+	}
+
+	log(LL_Debug, "Warming %d DB connections (%s)\n", connections, cold ? "cold" : "keepalive");
+}
+
+void DbWarmup::onAccountQueryDone(DB_AccountWarmup* query) {
+	onQueryDone(B_Account);
+}
+
+void DbWarmup::onAccountBatchQueryDone(DB_AccountBatchWarmup* query) {
+	onQueryDone(B_AccountBatch);
+}
+
+void DbWarmup::onSecurityNoCheckQueryDone(DB_SecurityNoCheckWarmup* query) {
+	onQueryDone(B_SecurityNoCheck);
+}
+
+void DbWarmup::onQueryDone(Binding binding) {
+	BindingState& state = bindings[binding];
+	uint64_t latency = uv_hrtime() - state.roundStartTime;
+
+	if(state.coldRound)
+		state.cold.add(latency);
+	else
+		state.warm.add(latency);
+}
+
+void DbWarmup::commandWarm(IWritableConsole* console, const std::vector<std::string>& args) {
+	DbWarmup* warmup = get();
+
+	if(!warmup->started) {
+		console->writef("DB warm-up is not started\r\n");
+		return;
+	}
+
+	warmup->warm(true);
+	console->writef("Warming %d DB connections\r\n", CONFIG_GET()->auth.dbWarmup.connections.get());
+}
+
+void DbWarmup::commandStats(IWritableConsole* console, const std::vector<std::string>& args) {
+	DbWarmup* warmup = get();
+
+	for(size_t i = 0; i < B_Count; i++) {
+		const BindingState& state = warmup->bindings[i];
+		uint64_t coldCount = state.cold.count ? state.cold.count : 1;
+		uint64_t warmCount = state.warm.count ? state.warm.count : 1;
+
+		console->writef("%s: cold queries: %llu, average %.3f ms, max %.3f ms, "
+		                "warm queries: %llu, average %.3f ms, max %.3f ms\r\n",
+		                state.name,
+		                (unsigned long long) state.cold.count,
+		                state.cold.total / 1000000.0 / coldCount,
+		                state.cold.max / 1000000.0,
+		                (unsigned long long) state.warm.count,
+		                state.warm.total / 1000000.0 / warmCount,
+		                state.warm.max / 1000000.0);
+	}
+}
+
+}  // namespace AuthServer
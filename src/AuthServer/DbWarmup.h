@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Core/Object.h"
+#include "DB_Account.h"
+#include "DB_AccountBatch.h"
+#include "DB_SecurityNoCheck.h"
+#include "uv.h"
+#include <list>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class IWritableConsole;
+
+namespace AuthServer {
+
+class DbWarmup;
+
+// Queries with an empty account, they only open DB connections and prepare the statement of their binding
+class DB_AccountWarmup : public DbQueryJobCallback<DB_AccountData, DbWarmup, DB_AccountWarmup> {
+	DECLARE_CLASS(AuthServer::DB_AccountWarmup)
+public:
+	DB_AccountWarmup(DbWarmup* warmup, DbCallback callback) : DbQueryJobCallback(warmup, callback) {}
+};
+
+class DB_AccountBatchWarmup : public DbQueryJobCallback<DB_AccountBatchData, DbWarmup, DB_AccountBatchWarmup> {
+	DECLARE_CLASS(AuthServer::DB_AccountBatchWarmup)
+public:
+	DB_AccountBatchWarmup(DbWarmup* warmup, DbCallback callback) : DbQueryJobCallback(warmup, callback) {}
+};
+
+class DB_SecurityNoCheckWarmup : public DbQueryJobCallback<DB_SecurityNoCheckData, DbWarmup, DB_SecurityNoCheckWarmup> {
+	DECLARE_CLASS(AuthServer::DB_SecurityNoCheckWarmup)
+public:
+	DB_SecurityNoCheckWarmup(DbWarmup* warmup, DbCallback callback) : DbQueryJobCallback(warmup, callback) {}
+};
+
+// Open auth.db.warmup.connections DB connections for login queries (db_account and db_securitynocheck, and
+// db_accountbatch if auth.db.batch.enable is true) at startup so the first logins don't wait for the connection and
+// statement preparation.
+// Connections are kept in use every auth.db.warmup.keepalive seconds if not 0, else the db.warmup command warms them
+// again (after closedb for example).
+// Used only in the event loop thread
+class DbWarmup : public Object {
+	DECLARE_CLASS(AuthServer::DbWarmup)
+
+public:
+	static void init();
+	static DbWarmup* get();
+
+	void start();
+	void stop();
+
+	// Cold: first queries at startup or on db.warmup command, likely opening connections
+	// Warm: keepalive queries on already opened connections
+	void warm(bool cold);
+
+protected:
+	static void commandWarm(IWritableConsole* console, const std::vector<std::string>& args);
+	static void commandStats(IWritableConsole* console, const std::vector<std::string>& args);
+
+	void onAccountQueryDone(DB_AccountWarmup* query);
+	void onAccountBatchQueryDone(DB_AccountBatchWarmup* query);
+	void onSecurityNoCheckQueryDone(DB_SecurityNoCheckWarmup* query);
+
+private:
+	enum Binding { B_Account, B_AccountBatch, B_SecurityNoCheck, B_Count };
+
+	struct LatencyStats {
+		uint64_t count;
+		uint64_t total;  // in ns
+		uint64_t max;
+
+		LatencyStats() : count(0), total(0), max(0) {}
+		void add(uint64_t latency);
+	};
+
+	struct BindingState {
+		const char* name;
+		uint64_t roundStartTime;
+		bool coldRound;
+		LatencyStats cold;
+		LatencyStats warm;
+	};
+
+	DbWarmup();
+
+	static void onKeepaliveTimer(uv_timer_t* timer);
+	void onQueryDone(Binding binding);
+
+	BindingState bindings[B_Count];
+	std::list<DbQueryJobRef> runningQueries;
+	uv_timer_t keepaliveTimer;
+	bool started;
+};
+
+}  // namespace AuthServer
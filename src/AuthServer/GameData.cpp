@@ -1,13 +1,19 @@
 #include "GameData.h"
+#include "../GlobalConfig.h"
 #include "ClientData.h"
 #include "Console/ConsoleCommands.h"
 #include "Core/Utils.h"
+#include "GameDataTeardown.h"
 #include "GameServerSession.h"
 #include "LogServerClient.h"
+#include "ServerListCache.h"
+#include "uv.h"
+#include <algorithm>
 
 namespace AuthServer {
 
 std::unordered_map<uint16_t, GameData*> GameData::servers;
+static MemoryCounter gameDataMemory("AuthServer::GameData");
 
 void GameData::init() {
 	ConsoleCommands::get()->addCommand(
@@ -31,8 +37,17 @@ GameData::GameData(GameServerSession* gameServerSession,
       isAdultServer(isAdultServer),
       playerCount(0),
       creationTime(time(nullptr)),
-      ready(false) {
+      pendingAdmissions(0),
+      nextAdmissionTime(0),
+      firstClient(nullptr),
+      clientCount(0),
+      ready(false),
+      removed(false),
+      memoryUsage(gameDataMemory, sizeof(GameData)) {
 	setDirtyObjectName();
+	memoryUsage.update(sizeof(GameData) + MemoryCounter::getHeapBytes(this->serverName) +
+	                   MemoryCounter::getHeapBytes(this->serverIp) +
+	                   MemoryCounter::getHeapBytes(this->serverScreenshotUrl));
 
 	if(guid != nullptr) {
 		this->guid = *guid;
@@ -105,6 +120,7 @@ GameData* GameData::tryAdd(GameServerSession* gameServerSession,
 		    gameServerSession, serverIdx, serverName, serverIp, serverPort, serverScreenshotUrl, isAdultServer, guid);
 
 		servers.insert(std::pair<uint16_t, GameData*>(serverIdx, gameData));
+		ServerListCache::invalidate();
 
 		return gameData;
 	} else {
@@ -117,7 +133,19 @@ GameData* GameData::tryAdd(GameServerSession* gameServerSession,
 
 void GameData::remove(GameData* gameData) {
 	servers.erase(gameData->serverIdx);
-	delete gameData;
+	ServerListCache::invalidate();
+
+	// The game server session is being closed or logged out
+	gameData->gameServerSession = nullptr;
+	gameData->removed = true;
+	GameDataTeardown::get()->add(gameData);
+}
+
+void GameData::setReady(bool ready) {
+	if(this->ready != ready) {
+		this->ready = ready;
+		ServerListCache::invalidate();
+	}
 }
 
 void GameData::setGameServer(GameServerSession* gameServerSession) {
@@ -130,9 +158,99 @@ void GameData::setGameServer(GameServerSession* gameServerSession) {
 			oldGameServerSession->setGameData(nullptr);
 		if(gameServerSession)
 			gameServerSession->setGameData(this);
+
+		// isReady() depends on the game server connection
+		ServerListCache::invalidate();
 	}
 }
 
+void GameData::incPlayerCount() {
+	uint32_t oldUserRatio = getUserRatio();
+	playerCount++;
+	if(getUserRatio() != oldUserRatio)
+		ServerListCache::invalidate();
+}
+
+void GameData::decPlayerCount() {
+	uint32_t oldUserRatio = getUserRatio();
+	playerCount--;
+	// Removed servers are not in the server list anymore
+	if(!removed && getUserRatio() != oldUserRatio)
+		ServerListCache::invalidate();
+}
+
+uint32_t GameData::getUserRatio() {
+	unsigned int maxPlayers = CONFIG_GET()->auth.game.maxPlayers;
+	uint32_t userRatio = playerCount * 100 / maxPlayers;
+
+	return (userRatio > 100) ? 100 : userRatio;
+}
+
+uint32_t GameData::admitClient(ClientData* client) {
+	if(CONFIG_GET()->auth.game.admissionEnable.get() == false)
+		return 0;
+
+	uint64_t maxPlayers = std::max(1, CONFIG_GET()->auth.game.maxPlayers.get());
+	uint64_t rampUp = std::max(1, CONFIG_GET()->auth.game.admissionRampUp.get());
+	uint64_t maxWait = std::max(0, CONFIG_GET()->auth.game.admissionMaxWait.get());
+	uint64_t now = uv_hrtime() / 1000000;
+
+	// maxplayers clients are admitted every rampup seconds
+	uint64_t interval = rampUp * 1000 / maxPlayers;
+
+	// Clients not using their slot are not accumulated, but allow a burst of one second worth of clients
+	if(nextAdmissionTime + 1000 < now)
+		nextAdmissionTime = now - 1000;
+
+	uint64_t admissionTime = nextAdmissionTime;
+	nextAdmissionTime += interval;
+
+	// When the game server is full, also wait for pending clients to log in
+	uint64_t usedSlots = playerCount + pendingAdmissions;
+	if(usedSlots >= maxPlayers)
+		admissionTime += (usedSlots - maxPlayers + 1) * interval;
+
+	client->admissionPending = true;
+	pendingAdmissions++;
+
+	if(admissionTime <= now)
+		return 0;
+
+	return (uint32_t) std::min((admissionTime - now + 999) / 1000, maxWait);
+}
+
+void GameData::releaseAdmission(ClientData* client) {
+	if(!client->admissionPending)
+		return;
+
+	client->admissionPending = false;
+	if(pendingAdmissions > 0)
+		pendingAdmissions--;
+}
+
+void GameData::addClient(ClientData* client) {
+	client->prevInServer = nullptr;
+	client->nextInServer = firstClient;
+	if(firstClient)
+		firstClient->prevInServer = client;
+	firstClient = client;
+	clientCount++;
+}
+
+void GameData::removeClient(ClientData* client) {
+	if(client->prevInServer)
+		client->prevInServer->nextInServer = client->nextInServer;
+	else
+		firstClient = client->nextInServer;
+
+	if(client->nextInServer)
+		client->nextInServer->prevInServer = client->prevInServer;
+
+	client->prevInServer = nullptr;
+	client->nextInServer = nullptr;
+	clientCount--;
+}
+
 void GameData::kickClient(ClientData* client) {
 	if(gameServerSession) {
 		gameServerSession->kickClient(client);
@@ -181,12 +299,14 @@ void GameData::commandList(IWritableConsole* console, const std::vector<std::str
 		Utils::getGmTime(time(nullptr) - server->getCreationTime(), &upTime);
 
 		console->writef(
-		    "index: %d, name: %s, address: %s:%d, players count: %u, uptime: %d:%02d:%02d:%02d, screenshot url: %s\r\n",
+		    "index: %d, name: %s, address: %s:%d, players count: %u, pending logins: %u, uptime: %d:%02d:%02d:%02d, "
+		    "screenshot url: %s\r\n",
 		    server->getServerIdx(),
 		    server->getServerName().c_str(),
 		    server->getServerIp().c_str(),
 		    server->getServerPort(),
 		    server->getPlayerCount(),
+		    server->getPendingAdmissions(),
 		    (upTime.tm_year - 1970) * 365 + upTime.tm_yday,
 		    upTime.tm_hour,
 		    upTime.tm_min,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../MemoryCounter.h"
 #include "Core/Object.h"
 #include <array>
 #include <stdint.h>
@@ -14,6 +15,7 @@ namespace AuthServer {
 
 class GameServerSession;
 class ClientData;
+class GameDataTeardown;
 
 class GameData : public Object {
 	DECLARE_CLASS(AuthServer::GameData)
@@ -31,9 +33,12 @@ public:
 	                        bool isAdultServer,
 	                        const std::array<uint8_t, 16>* guid,
 	                        GameData** oldGameData = nullptr);
+	// The game data is removed from the server list now, but deleted once all its clients are removed (see
+	// GameDataTeardown)
 	static void remove(GameData* gameData);
+	bool isRemoved() { return removed; }
 
-	void setReady(bool ready) { this->ready = ready; }
+	void setReady(bool ready);
 	bool isReady() { return getGameServer() != nullptr && ready; }
 
 	void kickClient(ClientData* client);
@@ -51,17 +56,33 @@ public:
 	bool getIsAdultServer() { return isAdultServer; }
 	const std::array<uint8_t, 16>& getGuid() { return guid; }
 
-	void incPlayerCount() { playerCount++; }
-	void decPlayerCount() { playerCount--; }
+	void incPlayerCount();
+	void decPlayerCount();
 	uint32_t getPlayerCount() { return playerCount; }
+	uint32_t getUserRatio();
 	time_t getCreationTime() { return creationTime; }
 
+	// Login admission: return the time in seconds the client must wait before connecting to the game server.
+	// The client is pending until it logs on the game server or is removed
+	uint32_t admitClient(ClientData* client);
+	void releaseAdmission(ClientData* client);
+	uint32_t getPendingAdmissions() { return pendingAdmissions; }
+
+	// Clients which selected this server, linked with ClientData::nextInServer so they can be removed without
+	// looking at other servers' clients
+	void addClient(ClientData* client);
+	void removeClient(ClientData* client);
+	ClientData* getFirstClient() { return firstClient; }
+	uint32_t getClientCount() { return clientCount; }
+
 protected:
 	void updateObjectName();
 
 	static void commandList(IWritableConsole* console, const std::vector<std::string>& args);
 
 private:
+	friend class GameDataTeardown;
+
 	GameData(GameServerSession* gameServerSession,
 	         uint16_t serverIdx,
 	         std::string serverName,
@@ -87,7 +108,16 @@ private:
 	uint32_t playerCount;
 	time_t creationTime;
 
+	uint32_t pendingAdmissions;
+	uint64_t nextAdmissionTime;  // in ms
+
+	ClientData* firstClient;
+	uint32_t clientCount;
+
 	bool ready;
+	bool removed;
+
+	TrackedMemory memoryUsage;
 };
 
 }  // namespace AuthServer
@@ -0,0 +1,104 @@
+#include "GameDataTeardown.h"
+#include "../GlobalConfig.h"
+#include "ClientData.h"
+#include "Console/ConsoleCommands.h"
+#include "GameData.h"
+#include "uv.h"
+
+namespace AuthServer {
+
+void GameDataTeardown::init() {
+	ConsoleCommands::get()->addCommand("gameserver.teardown.stats",
+	                                   "teardownstats",
+	                                   0,
+	                                   0,
+	                                   &commandStats,
+	                                   "Show removed game servers teardown statistics",
+	                                   "gameserver.teardown.stats : show removed clients count and event loop pauses");
+}
+
+GameDataTeardown* GameDataTeardown::get() {
+	static GameDataTeardown teardown;
+	return &teardown;
+}
+
+GameDataTeardown::GameDataTeardown() : completedTeardowns(0), removedClients(0), lastPause(0), maxPause(0) {}
+
+void GameDataTeardown::add(GameData* gameData) {
+	if(!gameData->getFirstClient()) {
+		destroyGameData(gameData);
+		return;
+	}
+
+	log(LL_Debug,
+	    "Removing %u clients of game server %s\n",
+	    gameData->getClientCount(),
+	    gameData->getServerName().c_str());
+
+	if(removedServers.empty())
+		teardownTimer.start(this, &GameDataTeardown::onTeardownTimer, 0, 0);
+	removedServers.push_back(gameData);
+}
+
+void GameDataTeardown::onTeardownTimer() {
+	int sliceSize = CONFIG_GET()->auth.game.teardownSliceSize.get();
+	uint64_t startTime = uv_hrtime();
+
+	if(sliceSize < 1)
+		sliceSize = 1;
+
+	for(int i = 0; i < sliceSize && !removedServers.empty(); i++) {
+		GameData* gameData = removedServers.front();
+
+		if(gameData->getFirstClient()) {
+			ClientData::removeServerClient(gameData);
+			removedClients++;
+		}
+
+		if(!gameData->getFirstClient()) {
+			removedServers.pop_front();
+			destroyGameData(gameData);
+		}
+	}
+
+	lastPause = uv_hrtime() - startTime;
+	if(lastPause > maxPause)
+		maxPause = lastPause;
+
+	if(!removedServers.empty())
+		teardownTimer.start(this, &GameDataTeardown::onTeardownTimer, 0, 0);
+}
+
+void GameDataTeardown::destroyGameData(GameData* gameData) {
+	completedTeardowns++;
+	delete gameData;
+}
+
+void GameDataTeardown::stop() {
+	teardownTimer.stop();
+
+	for(size_t i = 0; i < removedServers.size(); i++) {
+		ClientData::removeServer(removedServers[i]);
+		destroyGameData(removedServers[i]);
+	}
+	removedServers.clear();
+}
+
+void GameDataTeardown::commandStats(IWritableConsole* console, const std::vector<std::string>& args) {
+	GameDataTeardown* teardown = get();
+	uint32_t remainingClients = 0;
+
+	for(size_t i = 0; i < teardown->removedServers.size(); i++)
+		remainingClients += teardown->removedServers[i]->getClientCount();
+
+	console->writef("Game server teardowns: in progress: %d (%u clients left), completed: %llu, removed clients: %llu\r\n",
+	                (int) teardown->removedServers.size(),
+	                remainingClients,
+	                (unsigned long long) teardown->completedTeardowns,
+	                (unsigned long long) teardown->removedClients);
+	console->writef("Event loop pause per slice (in us): last: %llu, max: %llu\r\n",
+	                (unsigned long long) (teardown->lastPause / 1000),
+	                (unsigned long long) (teardown->maxPause / 1000));
+}
+
+}  // namespace AuthServer
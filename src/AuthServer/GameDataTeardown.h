@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Core/Object.h"
+#include "Core/Timer.h"
+#include <deque>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class IWritableConsole;
+
+namespace AuthServer {
+
+class GameData;
+
+// Remove clients of removed game servers a slice at a time, one slice per event loop iteration.
+// A game server with thousands of players going down then doesn't block other logins while its clients are removed.
+// Used only in the event loop thread
+class GameDataTeardown : public Object {
+	DECLARE_CLASS(AuthServer::GameDataTeardown)
+
+public:
+	static void init();
+	static GameDataTeardown* get();
+
+	// Take ownership of gameData (already removed from the server list), it is deleted when it has no more clients
+	void add(GameData* gameData);
+
+	// Remove all remaining clients now
+	void stop();
+
+protected:
+	static void commandStats(IWritableConsole* console, const std::vector<std::string>& args);
+
+private:
+	GameDataTeardown();
+
+	void onTeardownTimer();
+	void destroyGameData(GameData* gameData);
+
+	std::deque<GameData*> removedServers;
+	Timer<GameDataTeardown> teardownTimer;
+
+	uint64_t completedTeardowns;
+	uint64_t removedClients;
+	uint64_t lastPause;  // in ns
+	uint64_t maxPause;   // in ns
+};
+
+}  // namespace AuthServer
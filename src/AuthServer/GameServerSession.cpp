@@ -1,5 +1,6 @@
 #include "GameServerSession.h"
 #include "../GlobalConfig.h"
+#include "../PacketLatency.h"
 #include "ClientSession.h"
 #include "Core/PrintfFormats.h"
 #include "GameData.h"
@@ -17,11 +18,14 @@
 
 namespace AuthServer {
 
+static MemoryCounter gameServerSessionMemory("AuthServer::GameServerSession");
+
 GameServerSession::GameServerSession()
     : PacketSession(SessionType::AuthGame, SessionPacketOrigin::Server, EPIC_LATEST),
       gameData(nullptr),
       useAutoReconnectFeature(false),
-      securityNoSendMode(true) {}
+      securityNoSendMode(true),
+      memoryUsage(gameServerSessionMemory, sizeof(GameServerSession)) {}
 
 void GameServerSession::sendNotifyItemPurchased(ClientData* client) {
 	TS_AG_ITEM_PURCHASED itemPurchasedPacket;
@@ -79,6 +83,8 @@ void GameServerSession::setGameData(GameData* gameData) {
 }
 
 EventChain<PacketSession> GameServerSession::onPacketReceived(const TS_MESSAGE* packet) {
+	uint64_t startTime = uv_hrtime();
+
 	switch(packet->id) {
 		case TS_GA_LOGIN_WITH_LOGOUT::packetID:
 			useAutoReconnectFeature = true;
@@ -128,9 +134,12 @@ EventChain<PacketSession> GameServerSession::onPacketReceived(const TS_MESSAGE*
 
 		default:
 			log(LL_Debug, "Unknown packet ID: %d, size: %d\n", packet->id, packet->size);
-			break;
+			// Not recorded, the peer could create a histogram for each packet ID
+			return PacketSession::onPacketReceived(packet);
 	}
 
+	PacketLatency::record(PacketLatency::AuthGame, PacketLatency::Handler, packet->id, uv_hrtime() - startTime);
+
 	return PacketSession::onPacketReceived(packet);
 }
 
@@ -228,6 +237,7 @@ void GameServerSession::onAccountList(const TS_GA_ACCOUNT_LIST* packet) {
 		accountInfo.account[sizeof(((TS_GA_ACCOUNT_LIST::AccountInfo*) 0)->account) - 1] = '\0';
 		alreadyConnectedAccounts.push_back(accountInfo);
 	}
+	memoryUsage.update(sizeof(GameServerSession) + MemoryCounter::getHeapBytes(alreadyConnectedAccounts));
 	log(LL_Debug, "Added %d accounts\n", packet->count);
 
 	if(packet->final_packet) {
@@ -320,6 +330,9 @@ void GameServerSession::onClientLogin(const TS_GA_CLIENT_LOGIN* packet) {
 
 		client->connectedToGame();
 
+		char ip[INET6_ADDRSTRLEN];
+		client->getIp(ip);
+
 		LogServerClient::sendLog(LogServerClient::LM_ACCOUNT_LOGIN,
 		                         client->accountId,
 		                         client->pcBang,
@@ -334,7 +347,7 @@ void GameServerSession::onClientLogin(const TS_GA_CLIENT_LOGIN* packet) {
 		                         0,
 		                         client->account.c_str(),
 		                         -1,
-		                         client->ip,
+		                         ip,
 		                         -1,
 		                         0,
 		                         0,
@@ -363,6 +376,9 @@ void GameServerSession::onClientLogout(const TS_GA_CLIENT_LOGOUT* packet) {
 	if(!clientData)
 		return;
 
+	char ip[INET6_ADDRSTRLEN];
+	clientData->getIp(ip);
+
 	LogServerClient::sendLog(LogServerClient::LM_ACCOUNT_LOGOUT,
 	                         clientData->accountId,
 	                         0,
@@ -377,7 +393,7 @@ void GameServerSession::onClientLogout(const TS_GA_CLIENT_LOGOUT* packet) {
 	                         time(nullptr) - clientData->loginTime,
 	                         clientData->account.c_str(),
 	                         -1,
-	                         clientData->ip,
+	                         ip,
 	                         -1,
 	                         0,
 	                         0,
@@ -452,6 +468,7 @@ void GameServerSession::onSecurityNoCheck(const TS_GA_SECURITY_NO_CHECK* packet)
 		securityNoSendMode = false;
 
 	DB_SecurityNoCheckData::Input input(account, securityNo, mode);
+	input.requestTime = uv_hrtime();
 	securityNoCheckQueries.executeDbQuery<DB_SecurityNoCheckData, DB_SecurityNoCheck>(
 	    this, &GameServerSession::onSecurityNoCheckResult, input);
 }
@@ -460,6 +477,11 @@ void GameServerSession::onSecurityNoCheckResult(DB_SecurityNoCheck* query) {
 	bool ok = query->getResults().size() == 1;
 	DB_SecurityNoCheckData::Input* input = query->getInput();
 
+	PacketLatency::record(PacketLatency::AuthGame,
+	                      PacketLatency::Response,
+	                      TS_GA_SECURITY_NO_CHECK::packetID,
+	                      uv_hrtime() - input->requestTime);
+
 	if(ok)
 		log(LL_Debug, "Security no check for account %s: ok\n", input->account.c_str());
 	else
@@ -528,7 +550,7 @@ void GameServerSession::fillClientLoginExtendedResult(TS_AG_CLIENT_LOGIN_EXTENDE
                                                       ClientData* clientData) {
 	fillClientLoginResult(packet, account, result, clientData);
 	if(result == TS_RESULT_SUCCESS && clientData) {
-		memcpy(packet->ip, clientData->ip, INET6_ADDRSTRLEN);
+		clientData->getIp(packet->ip);
 		packet->loginTime = (uint32_t) clientData->loginTime;
 	} else {
 		packet->ip[0] = '\0';
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../MemoryCounter.h"
 #include "ClientData.h"
 #include "DB_SecurityNoCheck.h"
 #include "NetSession/PacketSession.h"
@@ -72,6 +73,8 @@ private:
 
 	std::vector<TS_GA_ACCOUNT_LIST::AccountInfo> alreadyConnectedAccounts;
 	DbQueryJobRef securityNoCheckQueries;
+
+	TrackedMemory memoryUsage;
 };
 
 }  // namespace AuthServer
@@ -0,0 +1,172 @@
+#include "LastServerIdxUpdater.h"
+#include "../GlobalConfig.h"
+#include "Console/ConsoleCommands.h"
+#include "DB_UpdateLastServerIdx.h"
+
+namespace AuthServer {
+
+void LastServerIdxUpdater::init() {
+	ConsoleCommands::get()->addCommand(
+	    "db.lastserveridx.stats",
+	    "lastserveridxstats",
+	    0,
+	    0,
+	    &commandStats,
+	    "Show last game server updates statistics",
+	    "db.lastserveridx.stats : show pending and written last game server updates and the queries latency");
+}
+
+LastServerIdxUpdater* LastServerIdxUpdater::get() {
+	static LastServerIdxUpdater updater;
+	return &updater;
+}
+
+LastServerIdxUpdater::LastServerIdxUpdater()
+    : updateEnabled(&CFG_CREATE("sql.db_updatelastserveridx.enable", true)),
+      stopping(false),
+      updateCount(0),
+      coalescedCount(0),
+      queryCount(0),
+      doneQueryCount(0),
+      totalLatency(0),
+      lastLatency(0),
+      maxLatency(0) {}
+
+void LastServerIdxUpdater::update(uint32_t accountId, uint16_t lastLoginServerIdx) {
+	int flushInterval = CONFIG_GET()->auth.dbLastServerIdx.flushInterval.get();
+
+	// Batched updates are disabled with the same flag as single updates
+	if(!updateEnabled->get())
+		return;
+
+	updateCount++;
+
+	if(flushInterval <= 0) {
+		DbQueryJob<DB_UpdateLastServerIdx>::executeNoResult(
+		    DB_UpdateLastServerIdx::Input(accountId, lastLoginServerIdx));
+		return;
+	}
+
+	if(pendingUpdates.empty())
+		flushTimer.start(this, &LastServerIdxUpdater::onFlushTimer, flushInterval, 0);
+
+	auto result = pendingUpdates.insert(std::make_pair(accountId, lastLoginServerIdx));
+	if(!result.second) {
+		result.first->second = lastLoginServerIdx;
+		coalescedCount++;
+	}
+
+	// If queries are running, the flush is done when they are done
+	if((int) pendingUpdates.size() >= CONFIG_GET()->auth.dbLastServerIdx.maxPending.get() && !hasRunningQueries())
+		flush();
+}
+
+void LastServerIdxUpdater::onFlushTimer() {
+	flush();
+}
+
+bool LastServerIdxUpdater::hasRunningQueries() {
+	// Remove references to queries already done
+	for(auto it = runningQueries.begin(); it != runningQueries.end();) {
+		if(!it->inProgress())
+			it = runningQueries.erase(it);
+		else
+			++it;
+	}
+
+	return !runningQueries.empty();
+}
+
+void LastServerIdxUpdater::flush() {
+	int flushInterval = CONFIG_GET()->auth.dbLastServerIdx.flushInterval.get();
+
+	flushTimer.stop();
+
+	if(pendingUpdates.empty())
+		return;
+
+	// Updates pending while the flag was disabled are dropped like single updates are
+	if(!updateEnabled->get()) {
+		pendingUpdates.clear();
+		return;
+	}
+
+	if(flushInterval <= 0)
+		flushInterval = 1;
+
+	// Queries of the previous flush could be executed after new ones and write older values
+	if(hasRunningQueries()) {
+		flushTimer.start(this, &LastServerIdxUpdater::onFlushTimer, flushInterval, 0);
+		return;
+	}
+
+	DB_UpdateLastServerIdxBatchData::Input input;
+	input.flushTime = uv_hrtime();
+	input.updates.reserve(DB_UpdateLastServerIdxBatchData::MAX_UPDATES);
+
+	for(auto it = pendingUpdates.begin(); it != pendingUpdates.end() && runningQueries.size() < MAX_RUNNING_QUERIES;) {
+		DB_UpdateLastServerIdxBatchData::Update update;
+		update.accountId = it->first;
+		update.lastLoginServerIdx = it->second;
+		input.updates.push_back(update);
+		it = pendingUpdates.erase(it);
+
+		if(input.updates.size() < DB_UpdateLastServerIdxBatchData::MAX_UPDATES && it != pendingUpdates.end())
+			continue;
+
+		runningQueries.emplace_back();
+		if(runningQueries.back().executeDbQuery<DB_UpdateLastServerIdxBatchData, DB_UpdateLastServerIdxBatch>(
+		       this, &LastServerIdxUpdater::onQueryDone, input))
+			queryCount++;
+		else
+			runningQueries.pop_back();
+
+		input.updates.clear();
+	}
+
+	// Remaining updates are written by the next flush
+	if(!pendingUpdates.empty())
+		flushTimer.start(this, &LastServerIdxUpdater::onFlushTimer, flushInterval, 0);
+}
+
+void LastServerIdxUpdater::onQueryDone(DB_UpdateLastServerIdxBatch* query) {
+	uint64_t latency = uv_hrtime() - query->getInput()->flushTime;
+
+	doneQueryCount++;
+	totalLatency += latency;
+	lastLatency = latency;
+	if(latency > maxLatency)
+		maxLatency = latency;
+
+	// Don't wait for the flush interval when stopping or when too many updates are pending.
+	// The timer runs the flush after this query reference is released
+	if(!pendingUpdates.empty() &&
+	   (stopping || (int) pendingUpdates.size() >= CONFIG_GET()->auth.dbLastServerIdx.maxPending.get()))
+		flushTimer.start(this, &LastServerIdxUpdater::onFlushTimer, 0, 0);
+}
+
+void LastServerIdxUpdater::stop() {
+	if(!pendingUpdates.empty())
+		log(LL_Info, "Writing %d pending last server updates\n", (int) pendingUpdates.size());
+
+	stopping = true;
+	flush();
+}
+
+void LastServerIdxUpdater::commandStats(IWritableConsole* console, const std::vector<std::string>& args) {
+	LastServerIdxUpdater* updater = get();
+	uint64_t doneQueries = updater->doneQueryCount ? updater->doneQueryCount : 1;
+
+	console->writef("Last server updates: %llu, coalesced: %llu, pending: %d\r\n",
+	                (unsigned long long) updater->updateCount,
+	                (unsigned long long) updater->coalescedCount,
+	                (int) updater->pendingUpdates.size());
+	console->writef("Queries: %llu, done: %llu, latency: last %.3f ms, average %.3f ms, max %.3f ms\r\n",
+	                (unsigned long long) updater->queryCount,
+	                (unsigned long long) updater->doneQueryCount,
+	                updater->lastLatency / 1000000.0,
+	                updater->totalLatency / 1000000.0 / doneQueries,
+	                updater->maxLatency / 1000000.0);
+}
+
+}  // namespace AuthServer
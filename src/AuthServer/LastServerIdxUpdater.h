@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Config/ConfigParamVal.h"
+#include "Core/Object.h"
+#include "Core/Timer.h"
+#include "DB_UpdateLastServerIdxBatch.h"
+#include <list>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class IWritableConsole;
+
+namespace AuthServer {
+
+// Write-behind buffer of the last game server selected by each account.
+// Only the last value of each account is kept, pending updates are written by DB_UpdateLastServerIdxBatch queries
+// every auth.db.lastserveridx.flushinterval milliseconds or as soon as auth.db.lastserveridx.maxpending accounts are
+// pending. If the flush interval is 0 (the default), each update is written immediately with DB_UpdateLastServerIdx.
+// Nothing is written while sql.db_updatelastserveridx.enable is false.
+// A flush waits for the queries of the previous one so an older value is never written after a newer one, and sends
+// at most MAX_RUNNING_QUERIES queries to leave DB connections to login queries. Other updates wait for the next one.
+// Used only in the event loop thread
+class LastServerIdxUpdater : public Object {
+	DECLARE_CLASS(AuthServer::LastServerIdxUpdater)
+
+public:
+	static void init();
+	static LastServerIdxUpdater* get();
+
+	void update(uint32_t accountId, uint16_t lastLoginServerIdx);
+	size_t getPendingCount() { return pendingUpdates.size(); }
+
+	// Write pending updates, the event loop must run until the queries are done
+	void stop();
+
+protected:
+	static void commandStats(IWritableConsole* console, const std::vector<std::string>& args);
+
+	void onQueryDone(DB_UpdateLastServerIdxBatch* query);
+
+private:
+	static const size_t MAX_RUNNING_QUERIES = 4;
+
+	LastServerIdxUpdater();
+
+	void onFlushTimer();
+	void flush();
+	bool hasRunningQueries();
+
+	cval<bool>* updateEnabled;  // sql.db_updatelastserveridx.enable
+	std::unordered_map<uint32_t, uint16_t> pendingUpdates;
+	std::list<DbQueryJobRef> runningQueries;
+	Timer<LastServerIdxUpdater> flushTimer;
+	bool stopping;  // Write remaining updates as soon as running queries are done
+
+	uint64_t updateCount;
+	uint64_t coalescedCount;  // Updates replaced by a newer one before being written
+	uint64_t queryCount;
+	uint64_t doneQueryCount;
+	uint64_t totalLatency;  // From the flush to the end of the query, in ns
+	uint64_t lastLatency;
+	uint64_t maxLatency;
+};
+
+}  // namespace AuthServer
@@ -23,7 +23,8 @@ struct LS_11N4S {
 
 LogServerClient* LogServerClient::instance = nullptr;
 
-LogServerClient::LogServerClient(cval<std::string>& ip, cval<int>& port) : ip(ip), port(port) {
+LogServerClient::LogServerClient(cval<std::string>& ip, cval<int>& port)
+    : ip(ip), port(port), pendingMessageCount(0), droppedMessageCount(0) {
 	instance = this;
 }
 
@@ -53,58 +54,60 @@ EventChain<SocketSession> LogServerClient::onConnected() {
 
 	sendLog(LM_SERVER_INFO, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, "START", -1);
 
-	for(size_t i = 0; i < pendingMessages.size(); i++) {
-		sendLog(pendingMessages[i]);
-	}
-	pendingMessages.clear();
+	// Pending messages are already encoded, send them after the login
+	outputBuffer.insert(outputBuffer.end(), pendingBuffer.begin(), pendingBuffer.end());
+	pendingBuffer.clear();
+	pendingMessageCount = 0;
 
 	return SocketSession::onConnected();
 }
 
 void LogServerClient::stop() {
 	sendLog(LM_SERVER_INFO, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, "END", -1);
+	flush();
 
 	closeSession();
 }
 
 EventChain<SocketSession> LogServerClient::onDisconnected(bool causedByRemote) {
 	log(LL_Info, "Disconnected from Log server %s:%d\n", ip.get().c_str(), port.get());
+
+	flushTimer.stop();
+
+	// Messages of this loop iteration were not written yet, keep them for the next connection
+	for(size_t offset = 0; offset < outputBuffer.size();) {
+		const LS_11N4S* packet = reinterpret_cast<const LS_11N4S*>(&outputBuffer[offset]);
+		const char* message = &outputBuffer[offset];
+		size_t size = packet->size;
+
+		if(pendingMessageCount < MAX_PENDING_MESSAGES) {
+			pendingBuffer.insert(pendingBuffer.end(), message, message + size);
+			pendingMessageCount++;
+		} else {
+			droppedMessageCount++;
+		}
+		offset += size;
+	}
+	outputBuffer.clear();
+
 	return SocketSession::onDisconnected(causedByRemote);
 }
 
-void LogServerClient::sendLog(const Message& message) {
-	LS_11N4S packet;
-	packet.thread_id = message.thread_id;
-	packet.type = message.type;
-	packet.id = message.id;
-	packet.n1 = message.n1;
-	packet.n2 = message.n2;
-	packet.n3 = message.n3;
-	packet.n4 = message.n4;
-	packet.n5 = message.n5;
-	packet.n6 = message.n6;
-	packet.n7 = message.n7;
-	packet.n8 = message.n8;
-	packet.n9 = message.n9;
-	packet.n10 = message.n10;
-	packet.n11 = message.n11;
-
-	packet.len1 = (uint16_t) message.str1.size();
-	packet.len2 = (uint16_t) message.str2.size();
-	packet.len3 = (uint16_t) message.str3.size();
-	packet.len4 = (uint16_t) message.str4.size();
-
-	packet.size = sizeof(packet) + packet.len1 + packet.len2 + packet.len3 + packet.len4;
-
-	instance->write(&packet, sizeof(packet));
-	if(packet.len1)
-		instance->write(&message.str1[0], packet.len1);
-	if(packet.len2)
-		instance->write(&message.str2[0], packet.len2);
-	if(packet.len3)
-		instance->write(&message.str3[0], packet.len3);
-	if(packet.len4)
-		instance->write(&message.str4[0], packet.len4);
+void LogServerClient::onFlushTimer() {
+	flush();
+}
+
+void LogServerClient::flush() {
+	flushTimer.stop();
+
+	if(outputBuffer.empty())
+		return;
+
+	if(isStarted())
+		write(&outputBuffer[0], outputBuffer.size());
+
+	// Keep the capacity for the next messages
+	outputBuffer.clear();
 }
 
 void LogServerClient::sendLog(unsigned short id,
@@ -130,49 +133,73 @@ void LogServerClient::sendLog(unsigned short id,
 	if(!instance || !instance->getStream() || instance->getStream()->getState() == Stream::UnconnectedState)
 		return;
 
-	Message message;
-
-	message.id = id;
-	message.thread_id = Utils::getPid();
-	message.type = 1;
-
-	message.n1 = n1;
-	message.n2 = n2;
-	message.n3 = n3;
-	message.n4 = n4;
-	message.n5 = n5;
-	message.n6 = n6;
-	message.n7 = n7;
-	message.n8 = n8;
-	message.n9 = n9;
-	message.n10 = n10;
-	message.n11 = n11;
-
-	if(len1 == NTS && str1)
-		len1 = (int) strlen(str1);
-
-	if(len2 == NTS && str2)
-		len2 = (int) strlen(str2);
-
-	if(len3 == NTS && str3)
-		len3 = (int) strlen(str3);
-
-	if(len4 == NTS && str4)
-		len4 = (int) strlen(str4);
-
-	if(str1)
-		message.str1.assign(str1, str1 + len1);
-	if(str2)
-		message.str2.assign(str2, str2 + len2);
-	if(str3)
-		message.str3.assign(str3, str3 + len3);
-	if(str4)
-		message.str4.assign(str4, str4 + len4);
-
-	if(instance->getStream()->getState() == Stream::ConnectedState)
-		instance->sendLog(message);
-	else if(instance->pendingMessages.size() < 100)
-		instance->pendingMessages.push_back(message);
+	bool connected = instance->getStream()->getState() == Stream::ConnectedState;
+
+	if(!connected && instance->pendingMessageCount >= MAX_PENDING_MESSAGES) {
+		instance->droppedMessageCount++;
+		return;
+	}
+
+	const char* strs[] = {str1, str2, str3, str4};
+	int lens[] = {len1, len2, len3, len4};
+	// The message size is sent as a 16 bits value, strings are truncated to fit in it
+	int remainingSize = 0xFFFF - (int) sizeof(LS_11N4S);
+	size_t size = sizeof(LS_11N4S);
+
+	for(int i = 0; i < 4; i++) {
+		if(!strs[i])
+			lens[i] = 0;
+		else if(lens[i] == NTS)
+			lens[i] = (int) strlen(strs[i]);
+
+		if(lens[i] < 0)
+			lens[i] = 0;
+		else if(lens[i] > remainingSize)
+			lens[i] = remainingSize;
+		remainingSize -= lens[i];
+		size += lens[i];
+	}
+
+	// Encode the message directly at the end of the buffer
+	std::vector<char>& buffer = connected ? instance->outputBuffer : instance->pendingBuffer;
+	size_t offset = buffer.size();
+	buffer.resize(offset + size);
+
+	LS_11N4S* packet = reinterpret_cast<LS_11N4S*>(&buffer[offset]);
+	packet->id = id;
+	packet->size = (uint16_t) size;
+	packet->type = 1;
+	packet->thread_id = Utils::getPid();
+	packet->n1 = n1;
+	packet->n2 = n2;
+	packet->n3 = n3;
+	packet->n4 = n4;
+	packet->n5 = n5;
+	packet->n6 = n6;
+	packet->n7 = n7;
+	packet->n8 = n8;
+	packet->n9 = n9;
+	packet->n10 = n10;
+	packet->n11 = n11;
+	packet->len1 = (uint16_t) lens[0];
+	packet->len2 = (uint16_t) lens[1];
+	packet->len3 = (uint16_t) lens[2];
+	packet->len4 = (uint16_t) lens[3];
+
+	char* data = &buffer[offset + sizeof(LS_11N4S)];
+	for(int i = 0; i < 4; i++) {
+		if(lens[i]) {
+			memcpy(data, strs[i], lens[i]);
+			data += lens[i];
+		}
+	}
+
+	if(!connected) {
+		instance->pendingMessageCount++;
+	} else if(offset == 0) {
+		// First message since the last flush
+		instance->flushTimer.start(instance, &LogServerClient::onFlushTimer, 0, 0);
+	}
 }
 
 }  // namespace AuthServer
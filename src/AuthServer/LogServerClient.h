@@ -1,8 +1,11 @@
 #pragma once
 
 #include "Config/ConfigParamVal.h"
+#include "Core/Timer.h"
 #include "NetSession/SocketSession.h"
 #include "NetSession/StartableObject.h"
+#include <stdint.h>
+#include <vector>
 
 namespace AuthServer {
 
@@ -24,29 +27,22 @@ public:
 		LM_GAME_SERVER_LOGOUT = 1102
 	};
 
-	struct Message {
-		uint16_t id;
-		uint8_t type;
-		uint32_t thread_id;
-
-		int64_t n1, n2, n3, n4, n5, n6, n7, n8, n9, n10, n11;
-		std::vector<char> str1;
-		std::vector<char> str2;
-		std::vector<char> str3;
-		std::vector<char> str4;
-	};
-
 	static const int NTS = -1;
 
 	bool start() { return connect(ip.get().c_str(), port.get()); }
 	void stop();
 	bool isStarted() { return getStream() && getStream()->getState() == Stream::ConnectedState; }
 
+	// For MetricsExporter
+	static bool isConnected() { return instance && instance->isStarted(); }
+	static size_t getPendingMessageCount() { return instance ? instance->pendingMessageCount : 0; }
+	static uint64_t getDroppedMessageCount() { return instance ? instance->droppedMessageCount : 0; }
+
 	EventChain<SocketSession> onConnected();
 	EventChain<SocketSession> onDisconnected(bool causedByRemote);
 
-	void sendLog(const Message& message);
-
+	// Messages are encoded in a buffer written once per event loop iteration.
+	// While not connected, up to MAX_PENDING_MESSAGES messages are kept and sent on connection
 	static void sendLog(unsigned short id,
 	                    uint64_t n1,
 	                    uint64_t n2,
@@ -69,11 +65,20 @@ public:
 	                    int len4);
 
 private:
+	static const size_t MAX_PENDING_MESSAGES = 100;
+
+	void onFlushTimer();
+	void flush();
+
 	static LogServerClient* instance;
 	cval<std::string>& ip;
 	cval<int>& port;
 
-	std::vector<Message> pendingMessages;
+	std::vector<char> outputBuffer;   // Encoded messages to write on the next loop iteration
+	std::vector<char> pendingBuffer;  // Encoded messages waiting for the connection
+	size_t pendingMessageCount;
+	uint64_t droppedMessageCount;  // Messages not kept because too many were pending
+	Timer<LogServerClient> flushTimer;
 };
 
 }  // namespace AuthServer
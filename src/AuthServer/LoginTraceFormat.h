@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+
+// Binary format of the login trace ring file written by LoginTracer and read by rzauth_trace2json.
+// The file is a LoginTraceFileHeader followed by capacity LoginTraceRecord. Records are written in a ring: record
+// number n is at index n % capacity, so when writtenRecords > capacity, the oldest record is at
+// writtenRecords % capacity.
+// Values are in the native byte order of the server.
+
+namespace AuthServer {
+
+enum LoginTraceStage : uint8_t {
+	LTS_Connection,         // Instant: the client is connected
+	LTS_RsaKeyExchange,     // RSA key packet received -> AES key sent (crypto thread queue and RSA decryption)
+	LTS_AccountQueue,       // Account packet received -> DB thread starts the query (batching window, DB queue)
+	LTS_AccountPreProcess,  // Account name check, password decryption and hash in the DB thread
+	LTS_DbExecute,          // Query sent to the DB -> first row or query done
+	LTS_RowDone,            // Account row processing in the DB thread (password check)
+	LTS_AccountResult,      // DB result handled in the event loop -> auth result sent
+	LTS_DuplicateKick,      // Already connected account kicked or removed
+	LTS_ServerList,         // Server list request handling and send
+	LTS_SelectServer,       // Server selection handling
+	LTS_Disconnection,      // Instant: the client is disconnected
+	LTS_Count
+};
+
+enum LoginTraceEventType : uint8_t { LTE_Begin, LTE_End, LTE_Instant };
+
+static const char LOGIN_TRACE_MAGIC[8] = {'R', 'Z', 'L', 'T', 'R', 'C', '0', '1'};
+
+struct LoginTraceFileHeader {
+	char magic[8];
+	uint32_t recordSize;
+	uint32_t capacity;        // Number of records in the ring
+	uint64_t writtenRecords;  // Total number of records written since the file creation
+	uint64_t startTimestamp;  // Monotonic time of the file creation in ns, same clock as records
+	uint64_t startUnixTime;   // Unix time of the file creation in seconds
+};
+
+struct LoginTraceRecord {
+	uint64_t timestamp;  // Monotonic time in ns (uv_hrtime)
+	uint32_t traceId;    // One trace per sampled client connection
+	uint16_t threadId;   // Index of the thread which recorded the event, 0 is the first thread seen
+	uint8_t stage;       // LoginTraceStage
+	uint8_t type;        // LoginTraceEventType
+};
+
+inline const char* getLoginTraceStageName(uint8_t stage) {
+	static const char* const names[LTS_Count] = {"connection",
+	                                             "rsa key exchange",
+	                                             "account queue",
+	                                             "account preprocess",
+	                                             "db execute",
+	                                             "row done",
+	                                             "account result",
+	                                             "duplicate kick",
+	                                             "server list",
+	                                             "select server",
+	                                             "disconnection"};
+
+	return stage < LTS_Count ? names[stage] : "unknown";
+}
+
+}  // namespace AuthServer
@@ -0,0 +1,157 @@
+#include "LoginTracer.h"
+#include "../GlobalConfig.h"
+#include "Core/EventLoop.h"
+#include <atomic>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+namespace AuthServer {
+
+static_assert(sizeof(LoginTraceRecord) == 16, "LoginTraceRecord must not have padding");
+static_assert(sizeof(LoginTraceFileHeader) == 40, "LoginTraceFileHeader must not have padding");
+
+static const int MAX_CAPACITY = 100000000;
+
+LoginTracer* LoginTracer::get() {
+	static LoginTracer tracer;
+	return &tracer;
+}
+
+LoginTracer::LoginTracer() : file(nullptr), nextTraceId(1), connectionCount(0), droppedRecords(0), started(false) {
+	uv_mutex_init(&lock);
+	memset(&header, 0, sizeof(header));
+}
+
+LoginTracer::~LoginTracer() {
+	if(file)
+		fclose(file);
+	uv_mutex_destroy(&lock);
+}
+
+void LoginTracer::start() {
+	int sampling = CONFIG_GET()->auth.trace.sampling.get();
+	int capacity = CONFIG_GET()->auth.trace.maxRecords.get();
+	std::string fileName = CONFIG_GET()->auth.trace.file.get();
+
+	if(started || sampling <= 0 || capacity <= 0)
+		return;
+
+	// Keep record offsets in a long
+	if(capacity > MAX_CAPACITY)
+		capacity = MAX_CAPACITY;
+
+	file = fopen(fileName.c_str(), "wb");
+	if(!file) {
+		log(LL_Error, "Can't open login trace file %s: %s\n", fileName.c_str(), strerror(errno));
+		return;
+	}
+
+	memcpy(header.magic, LOGIN_TRACE_MAGIC, sizeof(header.magic));
+	header.recordSize = sizeof(LoginTraceRecord);
+	header.capacity = (uint32_t) capacity;
+	header.writtenRecords = 0;
+	header.startTimestamp = uv_hrtime();
+	header.startUnixTime = (uint64_t) time(nullptr);
+	fwrite(&header, sizeof(header), 1, file);
+	fflush(file);
+
+	uv_timer_init(EventLoop::getLoop(), &flushTimer);
+	flushTimer.data = this;
+	// Don't keep the event loop alive just for this
+	uv_unref((uv_handle_t*) &flushTimer);
+	uv_timer_start(&flushTimer, &onFlushTimer, 1000, 1000);
+
+	started = true;
+	log(LL_Info, "Tracing 1 login out of %d to %s\n", sampling, fileName.c_str());
+}
+
+void LoginTracer::stop() {
+	if(!started)
+		return;
+
+	started = false;
+	uv_timer_stop(&flushTimer);
+	uv_close((uv_handle_t*) &flushTimer, nullptr);
+
+	flush();
+	fclose(file);
+	file = nullptr;
+
+	if(droppedRecords)
+		log(LL_Warning, "%llu login trace records dropped\n", (unsigned long long) droppedRecords);
+}
+
+uint32_t LoginTracer::startTrace() {
+	int sampling = CONFIG_GET()->auth.trace.sampling.get();
+
+	if(!started || sampling <= 0)
+		return 0;
+
+	if(connectionCount++ % sampling)
+		return 0;
+
+	uint32_t traceId = nextTraceId++;
+	if(nextTraceId == 0)
+		nextTraceId = 1;
+
+	return traceId;
+}
+
+void LoginTracer::addRecord(uint32_t traceId, LoginTraceStage stage, LoginTraceEventType type) {
+	static std::atomic<uint16_t> nextThreadId(0);
+	thread_local uint16_t threadId = nextThreadId++;
+	LoginTraceRecord record;
+
+	record.timestamp = uv_hrtime();
+	record.traceId = traceId;
+	record.threadId = threadId;
+	record.stage = stage;
+	record.type = type;
+
+	uv_mutex_lock(&lock);
+	// Records are written every second, don't keep more than what fits in the file
+	if(pendingRecords.size() < header.capacity)
+		pendingRecords.push_back(record);
+	else
+		droppedRecords++;
+	uv_mutex_unlock(&lock);
+}
+
+void LoginTracer::onFlushTimer(uv_timer_t* timer) {
+	LoginTracer* tracer = (LoginTracer*) timer->data;
+	tracer->flush();
+}
+
+void LoginTracer::flush() {
+	writingRecords.clear();
+	uv_mutex_lock(&lock);
+	pendingRecords.swap(writingRecords);
+	uv_mutex_unlock(&lock);
+
+	if(writingRecords.empty())
+		return;
+
+	// Write in at most 2 parts: up to the end of the ring, then from its beginning
+	size_t written = 0;
+	while(written < writingRecords.size()) {
+		uint64_t index = header.writtenRecords % header.capacity;
+		size_t count = writingRecords.size() - written;
+
+		if(count > header.capacity - index)
+			count = (size_t) (header.capacity - index);
+
+		fseek(file, (long) (sizeof(header) + index * sizeof(LoginTraceRecord)), SEEK_SET);
+		fwrite(&writingRecords[written], sizeof(LoginTraceRecord), count, file);
+
+		written += count;
+		header.writtenRecords += count;
+	}
+
+	// The header is updated last so a reader never sees records not yet written
+	fseek(file, 0, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, file);
+	fflush(file);
+}
+
+}  // namespace AuthServer
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Core/Object.h"
+#include "LoginTraceFormat.h"
+#include "uv.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+namespace AuthServer {
+
+// Sampled tracing of the login stages of client connections.
+// One connection out of auth.trace.sampling gets a trace ID (0 means not traced), events of traced connections are
+// recorded with a timestamp from the event loop and DB threads and written every second to the auth.trace.file ring
+// file (see LoginTraceFormat.h). rzauth_trace2json converts the file to Chrome trace JSON.
+// record() is thread safe, other functions must be used from the event loop thread
+class LoginTracer : public Object {
+	DECLARE_CLASS(AuthServer::LoginTracer)
+
+public:
+	static LoginTracer* get();
+
+	void start();
+	void stop();
+
+	// Return the trace ID of a new connection, 0 if it is not sampled
+	uint32_t startTrace();
+
+	static void record(uint32_t traceId, LoginTraceStage stage, LoginTraceEventType type) {
+		if(traceId)
+			get()->addRecord(traceId, stage, type);
+	}
+
+private:
+	LoginTracer();
+	~LoginTracer();
+
+	void addRecord(uint32_t traceId, LoginTraceStage stage, LoginTraceEventType type);
+	static void onFlushTimer(uv_timer_t* timer);
+	void flush();
+
+	uv_mutex_t lock;
+	std::vector<LoginTraceRecord> pendingRecords;  // Protected by lock
+	std::vector<LoginTraceRecord> writingRecords;
+
+	FILE* file;
+	LoginTraceFileHeader header;
+	uv_timer_t flushTimer;
+	uint32_t nextTraceId;
+	uint64_t connectionCount;
+	uint64_t droppedRecords;  // Protected by lock
+	bool started;
+};
+
+}  // namespace AuthServer
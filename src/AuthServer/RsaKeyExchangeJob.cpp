@@ -0,0 +1,61 @@
+#include "RsaKeyExchangeJob.h"
+#include "ClientSession.h"
+#include "RsaPublicKeyCache.h"
+#include <string.h>
+
+#include <openssl/err.h>
+#include <openssl/rsa.h>
+
+#include "AuthClient/Flat/TS_AC_AES_KEY_IV.h"
+
+namespace AuthServer {
+
+// ERR_error_string with a null buffer is not thread safe
+static std::string getOpenSslError(const char* prefix) {
+	char buffer[256];
+
+	ERR_error_string_n(ERR_get_error(), buffer, sizeof(buffer));
+	return std::string(prefix) + buffer;
+}
+
+RsaKeyExchangeJob::RsaKeyExchangeJob(ClientSession* session,
+                                     const unsigned char* pemKey,
+                                     int pemKeySize,
+                                     const unsigned char aesKey[32],
+                                     size_t keyCacheSize)
+    : session(session),
+      pemKey(pemKey, pemKey + pemKeySize),
+      keyCacheSize(keyCacheSize),
+      aesKeyMessage(nullptr, &TS_MESSAGE_WNA::destroy) {
+	memcpy(this->aesKey, aesKey, sizeof(this->aesKey));
+}
+
+void RsaKeyExchangeJob::onProcess() {
+	// OpenSSL error queue is per thread
+	ERR_clear_error();
+
+	std::shared_ptr<RSA> rsaCipher = RsaPublicKeyCache::get()->getKey(pemKey.data(), pemKey.size(), keyCacheSize);
+	if(!rsaCipher) {
+		errorMessage = getOpenSslError("RSA: invalid certificate: ");
+		return;
+	}
+
+	std::unique_ptr<TS_AC_AES_KEY_IV, void (*)(TS_MESSAGE*)> message(
+	    TS_MESSAGE_WNA::create<TS_AC_AES_KEY_IV, unsigned char>(RSA_size(rsaCipher.get())), &TS_MESSAGE_WNA::destroy);
+
+	int blockSize = RSA_public_encrypt(32, aesKey, message->rsa_encrypted_data, rsaCipher.get(), RSA_PKCS1_PADDING);
+	if(blockSize < 0) {
+		errorMessage = getOpenSslError("RSA: encrypt error: ");
+		return;
+	}
+
+	message->data_size = blockSize;
+	aesKeyMessage = std::move(message);
+}
+
+void RsaKeyExchangeJob::onDone() {
+	if(session)
+		session->onRsaKeyExchanged(this);
+}
+
+}  // namespace AuthServer
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CryptoWorkerPool.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+struct TS_MESSAGE;
+struct TS_AC_AES_KEY_IV;
+
+namespace AuthServer {
+
+class ClientSession;
+
+// Encrypt the client AES key with its RSA public key in a crypto worker thread
+class RsaKeyExchangeJob : public CryptoWorkerPool::Job {
+public:
+	RsaKeyExchangeJob(ClientSession* session,
+	                  const unsigned char* pemKey,
+	                  int pemKeySize,
+	                  const unsigned char aesKey[32],
+	                  size_t keyCacheSize);
+
+	// The session is gone, don't call it when the job is done
+	void cancel() { session = nullptr; }
+
+	// Return null if the key exchange failed, see getErrorMessage() then
+	const TS_AC_AES_KEY_IV* getAesKeyMessage() { return aesKeyMessage.get(); }
+	const std::string& getErrorMessage() { return errorMessage; }
+
+protected:
+	void onProcess();
+	void onDone();
+
+private:
+	ClientSession* session;
+	std::vector<unsigned char> pemKey;
+	unsigned char aesKey[32];
+	size_t keyCacheSize;
+
+	std::unique_ptr<TS_AC_AES_KEY_IV, void (*)(TS_MESSAGE*)> aesKeyMessage;
+	std::string errorMessage;
+};
+
+}  // namespace AuthServer
@@ -0,0 +1,118 @@
+#include "RsaPublicKeyCache.h"
+#include "Console/ConsoleCommands.h"
+
+#include <openssl/bio.h>
+#include <openssl/pem.h>
+#include <openssl/sha.h>
+
+namespace AuthServer {
+
+void RsaPublicKeyCache::init() {
+	ConsoleCommands::get()->addCommand("crypto.rsakeys",
+	                                   "rsakeys",
+	                                   0,
+	                                   1,
+	                                   &commandStats,
+	                                   "Show or clear the RSA public key cache",
+	                                   "crypto.rsakeys [clear] : show key cache statistics, clear it if \"clear\" is given");
+}
+
+RsaPublicKeyCache* RsaPublicKeyCache::get() {
+	static RsaPublicKeyCache cache;
+	return &cache;
+}
+
+RsaPublicKeyCache::RsaPublicKeyCache() : hits(0), misses(0), evictions(0) {
+	uv_mutex_init(&lock);
+}
+
+RsaPublicKeyCache::~RsaPublicKeyCache() {
+	uv_mutex_destroy(&lock);
+}
+
+std::shared_ptr<RSA> RsaPublicKeyCache::parseKey(const unsigned char* pemKey, size_t pemKeySize) {
+	std::unique_ptr<BIO, int (*)(BIO*)> bio(BIO_new_mem_buf((void*) pemKey, (int) pemKeySize), &BIO_free);
+	if(!bio)
+		return std::shared_ptr<RSA>();
+
+	RSA* rsaCipher = PEM_read_bio_RSA_PUBKEY(bio.get(), NULL, NULL, NULL);
+	if(!rsaCipher)
+		return std::shared_ptr<RSA>();
+
+	return std::shared_ptr<RSA>(rsaCipher, &RSA_free);
+}
+
+std::shared_ptr<RSA> RsaPublicKeyCache::getKey(const unsigned char* pemKey, size_t pemKeySize, size_t maxEntries) {
+	unsigned char digest[SHA256_DIGEST_LENGTH];
+	SHA256(pemKey, pemKeySize, digest);
+	std::string digestKey((const char*) digest, sizeof(digest));
+
+	uv_mutex_lock(&lock);
+	auto it = keysByDigest.find(digestKey);
+	if(it != keysByDigest.end()) {
+		keys.splice(keys.begin(), keys, it->second);
+		std::shared_ptr<RSA> rsaCipher = it->second->second;
+		hits++;
+		uv_mutex_unlock(&lock);
+
+		return rsaCipher;
+	}
+	misses++;
+	uv_mutex_unlock(&lock);
+
+	// Parse outside of the lock, if 2 threads parse the same key, the last one just replace the first one
+	std::shared_ptr<RSA> rsaCipher = parseKey(pemKey, pemKeySize);
+	if(!rsaCipher || maxEntries == 0)
+		return rsaCipher;
+
+	uv_mutex_lock(&lock);
+	it = keysByDigest.find(digestKey);
+	if(it != keysByDigest.end()) {
+		keys.splice(keys.begin(), keys, it->second);
+		it->second->second = rsaCipher;
+	} else {
+		keys.emplace_front(digestKey, rsaCipher);
+		keysByDigest[digestKey] = keys.begin();
+	}
+
+	while(keys.size() > maxEntries) {
+		keysByDigest.erase(keys.back().first);
+		keys.pop_back();
+		evictions++;
+	}
+	uv_mutex_unlock(&lock);
+
+	return rsaCipher;
+}
+
+void RsaPublicKeyCache::clear() {
+	uv_mutex_lock(&lock);
+	keysByDigest.clear();
+	keys.clear();
+	uv_mutex_unlock(&lock);
+}
+
+void RsaPublicKeyCache::commandStats(IWritableConsole* console, const std::vector<std::string>& args) {
+	RsaPublicKeyCache* cache = get();
+
+	if(!args.empty() && args[0] == "clear") {
+		cache->clear();
+		console->writef("RSA key cache cleared\r\n");
+		return;
+	}
+
+	uv_mutex_lock(&cache->lock);
+	size_t size = cache->keys.size();
+	uint64_t hits = cache->hits;
+	uint64_t misses = cache->misses;
+	uint64_t evictions = cache->evictions;
+	uv_mutex_unlock(&cache->lock);
+
+	console->writef("RSA key cache: keys: %d, hits: %llu, misses: %llu, evictions: %llu\r\n",
+	                (int) size,
+	                (unsigned long long) hits,
+	                (unsigned long long) misses,
+	                (unsigned long long) evictions);
+}
+
+}  // namespace AuthServer
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "uv.h"
+#include <list>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <openssl/rsa.h>
+
+class IWritableConsole;
+
+namespace AuthServer {
+
+// LRU cache of parsed RSA public keys keyed by the SHA-256 digest of their PEM.
+// Most clients send the same public key, so this avoid PEM/ASN.1 decoding on each connection.
+// Thread safe, used from crypto worker threads.
+class RsaPublicKeyCache {
+public:
+	static void init();
+	static RsaPublicKeyCache* get();
+
+	// Return the parsed key, parse and add it to the cache if not already there (when maxEntries > 0).
+	// Return null if the PEM is invalid, the OpenSSL error queue contains the reason then
+	std::shared_ptr<RSA> getKey(const unsigned char* pemKey, size_t pemKeySize, size_t maxEntries);
+
+	void clear();
+
+protected:
+	static void commandStats(IWritableConsole* console, const std::vector<std::string>& args);
+
+private:
+	RsaPublicKeyCache();
+	~RsaPublicKeyCache();
+
+	static std::shared_ptr<RSA> parseKey(const unsigned char* pemKey, size_t pemKeySize);
+
+	typedef std::list<std::pair<std::string, std::shared_ptr<RSA>>> KeyList;
+
+	uv_mutex_t lock;
+	// Most recently used first
+	KeyList keys;
+	std::unordered_map<std::string, KeyList::iterator> keysByDigest;
+
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+};
+
+}  // namespace AuthServer
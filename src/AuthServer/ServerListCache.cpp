@@ -0,0 +1,107 @@
+#include "ServerListCache.h"
+#include "../GlobalConfig.h"
+#include "Core/Object.h"
+#include "GameData.h"
+#include "Packet/MessageBuffer.h"
+#include "Packet/PacketBaseMessage.h"
+#include "Packet/PacketEpics.h"
+
+#include "AuthClient/TS_AC_SERVER_LIST.h"
+
+namespace AuthServer {
+
+// Each combination of parameters use one entry, when there are too many, just restart from an empty cache
+static const size_t MAX_CACHED_SERVER_LISTS = 256;
+
+std::unordered_map<uint64_t, std::vector<char>> ServerListCache::serverListMessages;
+uint32_t ServerListCache::cachedMaxPlayers = 0;
+
+const TS_MESSAGE* ServerListCache::getServerList(bool isEpic2,
+                                                 uint32_t maxVisibleServerIdx,
+                                                 uint16_t lastLoginServerIdx) {
+	uint32_t maxPlayers = CONFIG_GET()->auth.game.maxPlayers.get();
+
+	// user_ratio depends on the config value, drop everything if it was changed
+	if(maxPlayers != cachedMaxPlayers) {
+		invalidate();
+		cachedMaxPlayers = maxPlayers;
+	}
+
+	// Server indexes are 16 bits, all higher limits show the same servers
+	if(maxVisibleServerIdx > 0xFFFF)
+		maxVisibleServerIdx = 0xFFFF;
+
+	uint64_t key = ((uint64_t) maxVisibleServerIdx << 24) | ((uint64_t) lastLoginServerIdx << 8) | (isEpic2 ? 1 : 0);
+
+	auto it = serverListMessages.find(key);
+	if(it != serverListMessages.end())
+		return reinterpret_cast<const TS_MESSAGE*>(it->second.data());
+
+	return buildServerList(key, isEpic2, maxVisibleServerIdx, lastLoginServerIdx);
+}
+
+void ServerListCache::invalidate() {
+	serverListMessages.clear();
+}
+
+const TS_MESSAGE* ServerListCache::buildServerList(uint64_t key,
+                                                  bool isEpic2,
+                                                  uint32_t maxVisibleServerIdx,
+                                                  uint16_t lastLoginServerIdx) {
+	TS_AC_SERVER_LIST serverListPacket;
+	packet_version_t version = isEpic2 ? EPIC_2 : EPIC_9_1;
+
+	const std::unordered_map<uint16_t, GameData*>& serverList = GameData::getServerList();
+	std::unordered_map<uint16_t, GameData*>::const_iterator it, itEnd;
+
+	serverListPacket.servers.reserve(serverList.size());
+	serverListPacket.last_login_server_idx = lastLoginServerIdx;
+
+	for(it = serverList.cbegin(), itEnd = serverList.cend(); it != itEnd; ++it) {
+		GameData* serverInfo = it->second;
+
+		// servers with their index higher than maxPublicServerBaseIdx + serverIdxOffset are hidden
+		// serverIdxOffset is a per user value from the DB, default to 0
+		// maxPublicServerBaseIdx is a config value, default to 30
+		// So by default, servers with index > 30 are not shown in client's server list
+		if(serverInfo->getServerIdx() > maxVisibleServerIdx)
+			continue;
+
+		// Don't display not ready game servers (offline or not yet received all player list)
+		if(!serverInfo->isReady())
+			continue;
+
+		serverListPacket.servers.push_back(TS_SERVER_INFO());
+		TS_SERVER_INFO& serverData = serverListPacket.servers.back();
+
+		serverData.server_idx = serverInfo->getServerIdx();
+		serverData.server_port = serverInfo->getServerPort();
+		serverData.is_adult_server = serverInfo->getIsAdultServer();
+		serverData.server_ip = serverInfo->getServerIp();
+		serverData.server_name = serverInfo->getServerName();
+		serverData.server_screenshot_url = serverInfo->getServerScreenshotUrl();
+		serverData.user_ratio = serverInfo->getUserRatio();
+	}
+
+	MessageBuffer buffer(serverListPacket.getSize(version), version);
+	serverListPacket.serialize(&buffer);
+	if(buffer.checkFinalSize() == false) {
+		Object::logStatic(LL_Error,
+		                  "AuthServer::ServerListCache",
+		                  "Wrong server list packet buffer size, size: %d, field: %s\n",
+		                  (int) buffer.getSize(),
+		                  buffer.getFieldInOverflow().c_str());
+		return nullptr;
+	}
+
+	if(serverListMessages.size() >= MAX_CACHED_SERVER_LISTS)
+		serverListMessages.clear();
+
+	std::vector<char>& message = serverListMessages[key];
+	const char* data = static_cast<const char*>(buffer.getData());
+	message.assign(data, data + buffer.getSize());
+
+	return reinterpret_cast<const TS_MESSAGE*>(message.data());
+}
+
+}  // namespace AuthServer
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+struct TS_MESSAGE;
+
+namespace AuthServer {
+
+// Cache of already serialized TS_AC_SERVER_LIST messages.
+// The server list only depends on the GameData list and a few per client values (packet version, max visible server
+// index and last login server), so each combination is serialized once and reused until a GameData changes.
+// Not thread safe, must be used from the main event loop only (like GameData)
+class ServerListCache {
+public:
+	// Return a ready to send TS_AC_SERVER_LIST message, serialize it if not yet in the cache
+	static const TS_MESSAGE* getServerList(bool isEpic2, uint32_t maxVisibleServerIdx, uint16_t lastLoginServerIdx);
+
+	// Called when something shown in the server list change (server added, removed, ready state or user ratio)
+	static void invalidate();
+
+private:
+	static const TS_MESSAGE* buildServerList(uint64_t key,
+	                                         bool isEpic2,
+	                                         uint32_t maxVisibleServerIdx,
+	                                         uint16_t lastLoginServerIdx);
+
+	static std::unordered_map<uint64_t, std::vector<char>> serverListMessages;
+	static uint32_t cachedMaxPlayers;
+};
+
+}  // namespace AuthServer
@@ -10,6 +10,9 @@ DesPasswordCipher
 ServerInfo
 */
 
+#include "AuthServer/AccountBatcher.h"
+DECLARE_CLASSCOUNT_STATIC(AuthServer::AccountBatcher)
+
 #include "AuthServer/BillingInterface.h"
 DECLARE_CLASSCOUNT_STATIC(AuthServer::BillingInterface)
 
@@ -19,18 +22,51 @@ DECLARE_CLASSCOUNT_STATIC(AuthServer::ClientData)
 #include "AuthServer/ClientSession.h"
 DECLARE_CLASSCOUNT_STATIC(AuthServer::ClientSession)
 
+#include "AuthServer/CryptoWorkerPool.h"
+DECLARE_CLASSCOUNT_STATIC(AuthServer::CryptoWorkerPool)
+
 #include "AuthServer/DB_Account.h"
 DECLARE_CLASSCOUNT_STATIC(AuthServer::DB_Account)
 
+#include "AuthServer/DB_AccountBatch.h"
+DECLARE_CLASSCOUNT_STATIC(AuthServer::DB_AccountBatch)
+
 #include "AuthServer/DB_SecurityNoCheck.h"
 DECLARE_CLASSCOUNT_STATIC(AuthServer::DB_SecurityNoCheck)
 
+#include "AuthServer/DB_UpdateLastServerIdxBatch.h"
+DECLARE_CLASSCOUNT_STATIC(AuthServer::DB_UpdateLastServerIdxBatch)
+
+#include "AuthServer/DbJobStats.h"
+DECLARE_CLASSCOUNT_STATIC(AuthServer::DbJobStats)
+
+#include "AuthServer/DbWarmup.h"
+DECLARE_CLASSCOUNT_STATIC(AuthServer::DbWarmup)
+DECLARE_CLASSCOUNT_STATIC(AuthServer::DB_AccountWarmup)
+DECLARE_CLASSCOUNT_STATIC(AuthServer::DB_AccountBatchWarmup)
+DECLARE_CLASSCOUNT_STATIC(AuthServer::DB_SecurityNoCheckWarmup)
+
 #include "AuthServer/GameData.h"
 DECLARE_CLASSCOUNT_STATIC(AuthServer::GameData)
 
+#include "AuthServer/GameDataTeardown.h"
+DECLARE_CLASSCOUNT_STATIC(AuthServer::GameDataTeardown)
+
 #include "AuthServer/GameServerSession.h"
 DECLARE_CLASSCOUNT_STATIC(AuthServer::GameServerSession)
 
+#include "AuthServer/LastServerIdxUpdater.h"
+DECLARE_CLASSCOUNT_STATIC(AuthServer::LastServerIdxUpdater)
+
+#include "AuthServer/LoginTracer.h"
+DECLARE_CLASSCOUNT_STATIC(AuthServer::LoginTracer)
+
+#include "MetricsExporter.h"
+DECLARE_CLASSCOUNT_STATIC(MetricsExporter)
+
+#include "MetricsSession.h"
+DECLARE_CLASSCOUNT_STATIC(MetricsSession)
+
 #include "UploadServer/ClientSession.h"
 DECLARE_CLASSCOUNT_STATIC(UploadServer::ClientSession)
 
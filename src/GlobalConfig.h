@@ -45,25 +45,98 @@ struct GlobalConfig {
 			cval<std::string>& desKey;
 			cval<int>& maxPublicServerIdx;
 			cval<bool>& enableImbc;
+			cval<int>& cryptoThreads;
+			cval<int>& cryptoMaxPendingJobs;
+			cval<int>& rsaKeyCacheSize;
 
 			ClientConfig()
 			    : listener("auth.clients", "0.0.0.0", 4500, true, 301),
 			      desKey(CFG_CREATE("auth.clients.des_key", "MERONG")),
 			      maxPublicServerIdx(CFG_CREATE("auth.clients.maxpublicserveridx", 30)),
-			      enableImbc(CFG_CREATE("auth.clients.enableimbc", true)) {}
+			      enableImbc(CFG_CREATE("auth.clients.enableimbc", true)),
+			      cryptoThreads(CFG_CREATE("auth.clients.crypto.threads", 2)),
+			      cryptoMaxPendingJobs(CFG_CREATE("auth.clients.crypto.maxpendingjobs", 1000)),
+			      rsaKeyCacheSize(CFG_CREATE("auth.clients.crypto.rsakeycachesize", 64)) {}
 		} client;
 
+		struct DbBatchConfig {
+			cval<bool>& enable;
+			cval<int>& maxSize;
+			cval<int>& window;
+
+			DbBatchConfig()
+			    : enable(CFG_CREATE("auth.db.batch.enable", false)),
+			      maxSize(CFG_CREATE("auth.db.batch.maxsize", 8)),
+			      window(CFG_CREATE("auth.db.batch.window", 5)) {}
+		} dbBatch;
+
+		struct DbCacheConfig {
+			cval<bool>& enable;
+			cval<int>& maxSize;
+			cval<int>& ttl;
+
+			DbCacheConfig()
+			    : enable(CFG_CREATE("auth.db.cache.enable", false)),
+			      maxSize(CFG_CREATE("auth.db.cache.maxsize", 10000)),
+			      ttl(CFG_CREATE("auth.db.cache.ttl", 300)) {}
+		} dbCache;
+
+		struct DbLastServerIdxConfig {
+			cval<int>& flushInterval;
+			cval<int>& maxPending;
+
+			DbLastServerIdxConfig()
+			    : flushInterval(CFG_CREATE("auth.db.lastserveridx.flushinterval", 0)),
+			      maxPending(CFG_CREATE("auth.db.lastserveridx.maxpending", 1000)) {}
+		} dbLastServerIdx;
+
+		struct DbWarmupConfig {
+			cval<int>& connections;
+			cval<int>& keepalive;
+
+			DbWarmupConfig()
+			    : connections(CFG_CREATE("auth.db.warmup.connections", 2)),
+			      keepalive(CFG_CREATE("auth.db.warmup.keepalive", 0)) {}
+		} dbWarmup;
+
+		struct DbStatsConfig {
+			cval<int>& logInterval;
+
+			DbStatsConfig() : logInterval(CFG_CREATE("auth.db.stats.loginterval", 60)) {}
+		} dbStats;
+
 		struct GameConfig {
 			ListenerConfig listener;
 			cval<bool>& strictKick;
 			cval<int>& maxPlayers;
+			cval<bool>& admissionEnable;
+			cval<int>& admissionRampUp;
+			cval<int>& admissionMaxWait;
+			cval<int>& teardownSliceSize;
 
 			GameConfig()
 			    : listener("auth.gameserver", "127.0.0.1", 4502, true, 0),
 			      strictKick(CFG_CREATE("auth.gameserver.strictkick", true)),
-			      maxPlayers(CFG_CREATE("auth.gameserver.maxplayers", 400)) {}
+			      maxPlayers(CFG_CREATE("auth.gameserver.maxplayers", 400)),
+			      admissionEnable(CFG_CREATE("auth.gameserver.admission.enable", false)),
+			      admissionRampUp(CFG_CREATE("auth.gameserver.admission.rampup", 60)),
+			      admissionMaxWait(CFG_CREATE("auth.gameserver.admission.maxwait", 300)),
+			      teardownSliceSize(CFG_CREATE("auth.gameserver.teardownslice", 500)) {}
 		} game;
 
+		struct TraceConfig {
+			cval<int>& sampling;
+			cval<std::string>& file;
+			cval<int>& maxRecords;
+
+			TraceConfig()
+			    : sampling(CFG_CREATE("auth.trace.sampling", 0)),
+			      file(CFG_CREATE("auth.trace.file", "login_trace.bin")),
+			      maxRecords(CFG_CREATE("auth.trace.maxrecords", 1000000)) {
+				Utils::autoSetAbsoluteDir(file);
+			}
+		} trace;
+
 		struct BillingConfig {
 			ListenerConfig listener;
 
@@ -122,6 +195,15 @@ struct GlobalConfig {
 		      enable(CFG_CREATE("logclient.enable", true)) {}
 	} logclient;
 
+	struct MetricsConfig {
+		ListenerConfig listener;
+		cval<int>& refreshInterval;
+
+		MetricsConfig()
+		    : listener("metrics", "127.0.0.1", 4519, false, 31),
+		      refreshInterval(CFG_CREATE("metrics.refreshinterval", 5000)) {}
+	} metrics;
+
 	static GlobalConfig* get();
 	static void init();
 };
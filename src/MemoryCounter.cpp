@@ -0,0 +1,98 @@
+#include "MemoryCounter.h"
+#include "Console/ConsoleCommands.h"
+#include <algorithm>
+#include <string.h>
+
+void MemoryCounter::init() {
+	ConsoleCommands::get()->addCommand(
+	    "mem.bytes",
+	    "membytes",
+	    0,
+	    0,
+	    &commandList,
+	    "List approximate memory used by objects",
+	    "mem.bytes : list objects count, live bytes, max bytes and the change since the previous mem.bytes of each "
+	    "class");
+}
+
+std::vector<MemoryCounter*>& MemoryCounter::getCounters() {
+	static std::vector<MemoryCounter*> counters;
+	return counters;
+}
+
+uv_mutex_t* MemoryCounter::getCountersLock() {
+	struct CountersLock {
+		uv_mutex_t lock;
+		CountersLock() { uv_mutex_init(&lock); }
+	};
+	static CountersLock countersLock;
+	return &countersLock.lock;
+}
+
+MemoryCounter::MemoryCounter(const char* name)
+    : name(name), count(0), bytes(0), maxBytes(0), snapshotCount(0), snapshotBytes(0) {
+	uv_mutex_lock(getCountersLock());
+	getCounters().push_back(this);
+	uv_mutex_unlock(getCountersLock());
+}
+
+void MemoryCounter::add(size_t bytes) {
+	count++;
+	updateMaxBytes(this->bytes += bytes);
+}
+
+void MemoryCounter::remove(size_t bytes) {
+	count--;
+	this->bytes -= bytes;
+}
+
+void MemoryCounter::resize(size_t oldBytes, size_t newBytes) {
+	if(newBytes > oldBytes)
+		updateMaxBytes(bytes += newBytes - oldBytes);
+	else
+		bytes -= oldBytes - newBytes;
+}
+
+void MemoryCounter::updateMaxBytes(uint64_t value) {
+	uint64_t currentMax = maxBytes;
+
+	while(value > currentMax && !maxBytes.compare_exchange_weak(currentMax, value)) {
+	}
+}
+
+void MemoryCounter::commandList(IWritableConsole* console, const std::vector<std::string>& args) {
+	uv_mutex_lock(getCountersLock());
+
+	std::vector<MemoryCounter*> counters = getCounters();
+	std::sort(counters.begin(), counters.end(), [](const MemoryCounter* a, const MemoryCounter* b) {
+		return strcmp(a->getName(), b->getName()) < 0;
+	});
+
+	uint64_t totalBytes = 0;
+	int64_t totalDelta = 0;
+
+	for(size_t i = 0; i < counters.size(); i++) {
+		MemoryCounter* counter = counters[i];
+		uint64_t count = counter->getCount();
+		uint64_t bytes = counter->getBytes();
+
+		console->writef("%s: count: %llu (%+lld), bytes: %llu (%+lld), max: %llu\r\n",
+		                counter->getName(),
+		                (unsigned long long) count,
+		                (long long) (count - counter->snapshotCount),
+		                (unsigned long long) bytes,
+		                (long long) (bytes - counter->snapshotBytes),
+		                (unsigned long long) counter->getMaxBytes());
+
+		totalBytes += bytes;
+		totalDelta += (int64_t) (bytes - counter->snapshotBytes);
+		counter->snapshotCount = count;
+		counter->snapshotBytes = bytes;
+	}
+
+	console->writef("Total: %llu KB (%+lld KB)\r\n",
+	                (unsigned long long) (totalBytes / 1024),
+	                (long long) (totalDelta / 1024));
+
+	uv_mutex_unlock(getCountersLock());
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "uv.h"
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class IWritableConsole;
+
+// Approximate live memory of the objects of a class, including memory they own (strings, vectors).
+// Objects add their size when created and remove it when deleted, see TrackedMemory for objects whose owned memory
+// changes over time. mem.bytes shows live bytes, high-water mark and delta since the previous mem.bytes.
+// Counters are static objects never destroyed and are thread safe.
+class MemoryCounter {
+public:
+	explicit MemoryCounter(const char* name);
+
+	static void init();
+
+	void add(size_t bytes);
+	void remove(size_t bytes);
+	void resize(size_t oldBytes, size_t newBytes);
+
+	const char* getName() const { return name; }
+	uint64_t getCount() const { return count; }
+	uint64_t getBytes() const { return bytes; }
+	uint64_t getMaxBytes() const { return maxBytes; }
+
+	// Heap memory owned by a container, 0 for strings stored inline (small string optimization)
+	static size_t getHeapBytes(const std::string& str) { return str.capacity() > 15 ? str.capacity() + 1 : 0; }
+	template<class T> static size_t getHeapBytes(const std::vector<T>& vector) {
+		return vector.capacity() * sizeof(T);
+	}
+
+protected:
+	static void commandList(IWritableConsole* console, const std::vector<std::string>& args);
+
+private:
+	static std::vector<MemoryCounter*>& getCounters();
+	static uv_mutex_t* getCountersLock();
+
+	void updateMaxBytes(uint64_t value);
+
+	const char* name;
+	std::atomic<uint64_t> count;
+	std::atomic<uint64_t> bytes;
+	std::atomic<uint64_t> maxBytes;
+
+	// Values at the previous mem.bytes, protected by the counters lock
+	uint64_t snapshotCount;
+	uint64_t snapshotBytes;
+};
+
+// Member of a counted object: the object memory is counted while the member exists.
+// Call update() with the new total when the object owned memory changes
+class TrackedMemory {
+public:
+	TrackedMemory(MemoryCounter& counter, size_t bytes) : counter(counter), bytes(bytes) { counter.add(bytes); }
+	~TrackedMemory() { counter.remove(bytes); }
+
+	void update(size_t newBytes) {
+		counter.resize(bytes, newBytes);
+		bytes = newBytes;
+	}
+
+private:
+	TrackedMemory(const TrackedMemory&) = delete;
+	TrackedMemory& operator=(const TrackedMemory&) = delete;
+
+	MemoryCounter& counter;
+	size_t bytes;
+};
@@ -0,0 +1,264 @@
+#include "MetricsExporter.h"
+#include "AuthServer/ClientData.h"
+#include "AuthServer/DbJobStats.h"
+#include "AuthServer/GameData.h"
+#include "AuthServer/LastServerIdxUpdater.h"
+#include "AuthServer/LogServerClient.h"
+#include "Core/EventLoop.h"
+#include "GlobalConfig.h"
+#include "PacketEnums.h"
+#include "UploadServer/UploadRequest.h"
+#include <algorithm>
+#include <stdarg.h>
+#include <stdio.h>
+#include <vector>
+
+static const char* getResultName(uint16_t result) {
+	switch(result) {
+		case TS_RESULT_SUCCESS:
+			return "TS_RESULT_SUCCESS";
+		case TS_RESULT_NOT_EXIST:
+			return "TS_RESULT_NOT_EXIST";
+		case TS_RESULT_DB_ERROR:
+			return "TS_RESULT_DB_ERROR";
+		case TS_RESULT_ACCESS_DENIED:
+			return "TS_RESULT_ACCESS_DENIED";
+		case TS_RESULT_UNKNOWN:
+			return "TS_RESULT_UNKNOWN";
+		case TS_RESULT_INVALID_TEXT:
+			return "TS_RESULT_INVALID_TEXT";
+		case TS_RESULT_INVALID_ARGUMENT:
+			return "TS_RESULT_INVALID_ARGUMENT";
+		case TS_RESULT_ALREADY_EXIST:
+			return "TS_RESULT_ALREADY_EXIST";
+		case TS_RESULT_LIMIT_MAX:
+			return "TS_RESULT_LIMIT_MAX";
+		case TS_RESULT_CLIENT_SIDE_ERROR:
+			return "TS_RESULT_CLIENT_SIDE_ERROR";
+		default:
+			return nullptr;
+	}
+}
+
+static void appendf(std::string* out, const char* format, ...) {
+	char buffer[512];
+	va_list args;
+
+	va_start(args, format);
+	int size = vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+
+	if(size > 0)
+		out->append(buffer, std::min((size_t) size, sizeof(buffer) - 1));
+}
+
+static void appendHeader(std::string* out, const char* name, const char* type, const char* help) {
+	appendf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// Label values can contain any character except \, " and new lines which must be escaped
+static std::string escapeLabel(const std::string& value) {
+	std::string escaped;
+
+	escaped.reserve(value.size());
+	for(size_t i = 0; i < value.size(); i++) {
+		char c = value[i];
+
+		if(c == '\\' || c == '"') {
+			escaped.push_back('\\');
+			escaped.push_back(c);
+		} else if(c == '\n') {
+			escaped.append("\\n");
+		} else {
+			escaped.push_back(c);
+		}
+	}
+
+	return escaped;
+}
+
+static void appendResults(std::string* out,
+                          const char* name,
+                          const char* help,
+                          const std::map<uint16_t, uint64_t>& results) {
+	appendHeader(out, name, "counter", help);
+	for(auto it = results.begin(); it != results.end(); ++it) {
+		const char* resultName = getResultName(it->first);
+
+		if(resultName)
+			appendf(out, "%s{result=\"%s\"} %llu\n", name, resultName, (unsigned long long) it->second);
+		else
+			appendf(out, "%s{result=\"%u\"} %llu\n", name, (unsigned int) it->first, (unsigned long long) it->second);
+	}
+}
+
+static void appendDbJobs(std::string* out) {
+	using AuthServer::DbJobStats;
+	DbJobStats* stats = DbJobStats::get();
+
+	appendHeader(out, "rzauth_db_jobs_queued", "gauge", "DB queries waiting for a DB thread");
+	for(int i = 0; i < DbJobStats::B_Count; i++) {
+		const DbJobStats::BindingStats& binding = stats->getBinding((DbJobStats::Binding) i);
+		appendf(out, "rzauth_db_jobs_queued{binding=\"%s\"} %d\n", binding.name, (int) binding.queued);
+	}
+
+	appendHeader(out, "rzauth_db_jobs_running", "gauge", "DB queries being executed");
+	for(int i = 0; i < DbJobStats::B_Count; i++) {
+		const DbJobStats::BindingStats& binding = stats->getBinding((DbJobStats::Binding) i);
+		appendf(out, "rzauth_db_jobs_running{binding=\"%s\"} %d\n", binding.name, (int) binding.running);
+	}
+
+	appendHeader(out, "rzauth_db_jobs_total", "counter", "DB queries done by result");
+	for(int i = 0; i < DbJobStats::B_Count; i++) {
+		const DbJobStats::BindingStats& binding = stats->getBinding((DbJobStats::Binding) i);
+		appendf(out,
+		        "rzauth_db_jobs_total{binding=\"%s\",result=\"completed\"} %llu\n"
+		        "rzauth_db_jobs_total{binding=\"%s\",result=\"failed\"} %llu\n"
+		        "rzauth_db_jobs_total{binding=\"%s\",result=\"cancelled\"} %llu\n",
+		        binding.name,
+		        (unsigned long long) binding.completed,
+		        binding.name,
+		        (unsigned long long) binding.failed,
+		        binding.name,
+		        (unsigned long long) binding.cancelled);
+	}
+}
+
+MetricsExporter* MetricsExporter::get() {
+	static MetricsExporter exporter;
+	return &exporter;
+}
+
+MetricsExporter::MetricsExporter() : pendingAccountRequests(0), started(false) {}
+
+void MetricsExporter::start() {
+	int interval = CONFIG_GET()->metrics.refreshInterval.get();
+
+	if(started)
+		return;
+
+	if(interval <= 0)
+		interval = 1;
+
+	render();
+
+	uv_timer_init(EventLoop::getLoop(), &refreshTimer);
+	refreshTimer.data = this;
+	// Don't keep the event loop alive just for this
+	uv_unref((uv_handle_t*) &refreshTimer);
+	uv_timer_start(&refreshTimer, &onRefreshTimer, interval, interval);
+
+	started = true;
+}
+
+void MetricsExporter::stop() {
+	if(!started)
+		return;
+
+	started = false;
+	uv_timer_stop(&refreshTimer);
+	uv_close((uv_handle_t*) &refreshTimer, nullptr);
+}
+
+const std::string& MetricsExporter::getResponse() {
+	if(response.empty())
+		render();
+
+	return response;
+}
+
+void MetricsExporter::onRefreshTimer(uv_timer_t* timer) {
+	MetricsExporter* exporter = (MetricsExporter*) timer->data;
+	exporter->render();
+}
+
+void MetricsExporter::render() {
+	std::string body;
+	const auto& servers = AuthServer::GameData::getServerList();
+	std::vector<AuthServer::GameData*> sortedServers;
+
+	body.reserve(response.size() > 0 ? response.size() : 4096);
+
+	appendHeader(&body, "rzauth_clients_connected", "gauge", "Authenticated client accounts");
+	appendf(&body, "rzauth_clients_connected %u\n", AuthServer::ClientData::getClientCount());
+
+	sortedServers.reserve(servers.size());
+	for(auto it = servers.begin(); it != servers.end(); ++it)
+		sortedServers.push_back(it->second);
+	std::sort(sortedServers.begin(),
+	          sortedServers.end(),
+	          [](AuthServer::GameData* a, AuthServer::GameData* b) { return a->getServerIdx() < b->getServerIdx(); });
+
+	appendHeader(&body, "rzauth_gameserver_players", "gauge", "Players connected to each game server");
+	for(size_t i = 0; i < sortedServers.size(); i++) {
+		AuthServer::GameData* server = sortedServers[i];
+
+		appendf(&body,
+		        "rzauth_gameserver_players{server_idx=\"%u\",server_name=\"%s\"} %u\n",
+		        (unsigned int) server->getServerIdx(),
+		        escapeLabel(server->getServerName()).c_str(),
+		        server->getPlayerCount());
+	}
+
+	appendHeader(&body, "rzauth_gameserver_ready", "gauge", "1 if the game server accepts players");
+	for(size_t i = 0; i < sortedServers.size(); i++) {
+		AuthServer::GameData* server = sortedServers[i];
+
+		appendf(&body,
+		        "rzauth_gameserver_ready{server_idx=\"%u\",server_name=\"%s\"} %d\n",
+		        (unsigned int) server->getServerIdx(),
+		        escapeLabel(server->getServerName()).c_str(),
+		        server->isReady() ? 1 : 0);
+	}
+
+	appendHeader(&body,
+	             "rzauth_db_account_requests_pending",
+	             "gauge",
+	             "Account requests waiting for their DB query result");
+	appendf(&body, "rzauth_db_account_requests_pending %u\n", pendingAccountRequests);
+
+	appendHeader(&body,
+	             "rzauth_db_lastserveridx_updates_pending",
+	             "gauge",
+	             "Last server updates waiting to be written to the DB");
+	appendf(&body,
+	        "rzauth_db_lastserveridx_updates_pending %u\n",
+	        (unsigned int) AuthServer::LastServerIdxUpdater::get()->getPendingCount());
+
+	appendDbJobs(&body);
+
+	appendResults(&body, "rzauth_login_results_total", "Account request results sent to clients", loginResults);
+
+	appendHeader(&body, "rzauth_logclient_connected", "gauge", "1 if connected to the Log Server");
+	appendf(&body, "rzauth_logclient_connected %d\n", AuthServer::LogServerClient::isConnected() ? 1 : 0);
+
+	appendHeader(&body,
+	             "rzauth_logclient_pending_messages",
+	             "gauge",
+	             "Log messages waiting for the Log Server connection");
+	appendf(&body,
+	        "rzauth_logclient_pending_messages %u\n",
+	        (unsigned int) AuthServer::LogServerClient::getPendingMessageCount());
+
+	appendHeader(&body,
+	             "rzauth_logclient_dropped_messages_total",
+	             "counter",
+	             "Log messages dropped because too many were waiting for the Log Server connection");
+	appendf(&body,
+	        "rzauth_logclient_dropped_messages_total %llu\n",
+	        (unsigned long long) AuthServer::LogServerClient::getDroppedMessageCount());
+
+	appendHeader(&body, "rzauth_upload_requests_pending", "gauge", "Upload requests waiting for the client upload");
+	appendf(&body, "rzauth_upload_requests_pending %u\n", UploadServer::UploadRequest::getClientCount());
+
+	appendResults(&body, "rzauth_upload_results_total", "Upload results sent to clients", uploadResults);
+
+	response.clear();
+	appendf(&response,
+	        "HTTP/1.1 200 OK\r\n"
+	        "Content-Type: text/plain; version=0.0.4\r\n"
+	        "Content-Length: %u\r\n"
+	        "\r\n",
+	        (unsigned int) body.size());
+	response.append(body);
+}
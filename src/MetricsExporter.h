@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Core/Object.h"
+#include "uv.h"
+#include <map>
+#include <stdint.h>
+#include <string>
+
+// Server counters in the Prometheus text format, served by MetricsSession on the metrics listener.
+// The HTTP response is rendered every metrics.refreshinterval milliseconds, scrapes only write the last rendered one.
+// Used only in the event loop thread
+class MetricsExporter : public Object {
+	DECLARE_CLASS(MetricsExporter)
+
+public:
+	static MetricsExporter* get();
+
+	void start();
+	void stop();
+
+	// Full HTTP response with the last rendered metrics
+	const std::string& getResponse();
+
+	// TS_RESULT_* sent to auth and upload clients
+	void countLoginResult(uint16_t result) { loginResults[result]++; }
+	void countUploadResult(uint16_t result) { uploadResults[result]++; }
+
+	// Account requests waiting for their DB result (batched or not)
+	void addPendingAccountRequest() { pendingAccountRequests++; }
+	void removePendingAccountRequest() { pendingAccountRequests--; }
+
+private:
+	MetricsExporter();
+
+	static void onRefreshTimer(uv_timer_t* timer);
+	void render();
+
+	std::map<uint16_t, uint64_t> loginResults;
+	std::map<uint16_t, uint64_t> uploadResults;
+	uint32_t pendingAccountRequests;
+
+	std::string response;
+	uv_timer_t refreshTimer;
+	bool started;
+};
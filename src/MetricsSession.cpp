@@ -0,0 +1,90 @@
+#include "MetricsSession.h"
+#include "MetricsExporter.h"
+#include <string.h>
+
+static const char* const htmlNotFound = "HTTP/1.1 404 Not Found\r\n"
+                                        "Content-Type: text/html\r\n"
+                                        "Content-Length: 22\r\n"
+                                        "\r\n"
+                                        "<h1>404 Not Found</h1>";
+static size_t htmlNotFoundSize = strlen(htmlNotFound);
+
+static const size_t MAX_URL_SIZE = 255;
+static MemoryCounter metricsSessionMemory("MetricsSession");
+
+MetricsSession::MetricsSession() : memoryUsage(metricsSessionMemory, sizeof(MetricsSession)) {
+	this->status = WaitStatusLine;
+	this->nextByteToMatch = 0;
+}
+
+EventChain<SocketSession> MetricsSession::onDataReceived() {
+	std::vector<char> buffer;
+
+	if(getStream()->getAvailableBytes() > 0) {
+		getStream()->readAll(&buffer);
+		parseData(buffer);
+	}
+
+	return SocketSession::onDataReceived();
+}
+
+void MetricsSession::parseData(const std::vector<char>& data) {
+	static const char* const beginUrl = "GET ";
+	static const char* const endHeader = "\r\n\r\n";
+	const char* begin = &data[0];
+	const char* end = &data[0] + data.size();
+
+	for(const char* p = begin; p < end; p++) {
+		if(status == WaitStatusLine) {
+			if(*p == beginUrl[nextByteToMatch]) {
+				nextByteToMatch++;
+				if(nextByteToMatch >= 4) {
+					status = RetrievingStatusLine;
+					nextByteToMatch = 0;
+				}
+			} else {
+				nextByteToMatch = 0;
+			}
+		} else if(status == RetrievingStatusLine) {
+			if(*p == '\r' || *p == '\n') {
+				status = WaitEndOfHeaders;
+			} else if(*p >= 32 && *p <= 126 && url.size() < MAX_URL_SIZE) {
+				url.push_back(*p);
+			} else {
+				status = WaitStatusLine;
+				nextByteToMatch = 0;
+				url.clear();
+			}
+		}
+
+		if(status == RetrievingStatusLine || status == WaitEndOfHeaders) {
+			if(*p == endHeader[nextByteToMatch]) {
+				nextByteToMatch++;
+				if(nextByteToMatch >= 4) {
+					status = WaitStatusLine;
+					nextByteToMatch = 0;
+
+					// Scrapers use HTTP/1.1, curl or wget may use HTTP/1.0
+					size_t versionPos = url.rfind(" HTTP/1.");
+					if(versionPos != std::string::npos && versionPos + 9 == url.size())
+						parseUrl(url.substr(0, versionPos));
+
+					url.clear();
+				}
+			} else {
+				nextByteToMatch = 0;
+			}
+		}
+	}
+}
+
+void MetricsSession::parseUrl(const std::string& urlString) {
+	std::string path = urlString.substr(0, urlString.find('?'));
+
+	if(path == "/metrics" || path == "/") {
+		const std::string& response = MetricsExporter::get()->getResponse();
+		getStream()->write(response.data(), response.size());
+	} else {
+		getStream()->write(htmlNotFound, htmlNotFoundSize);
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "MemoryCounter.h"
+#include "NetSession/SocketSession.h"
+#include <string>
+
+// HTTP connection of the metrics listener (like UploadServer::IconServerSession).
+// GET /metrics (or /) returns the metrics rendered by MetricsExporter, other requests get a 404
+class MetricsSession : public SocketSession {
+	DECLARE_CLASS(MetricsSession)
+public:
+	MetricsSession();
+
+protected:
+	EventChain<SocketSession> onDataReceived();
+
+	void parseData(const std::vector<char>& data);
+	void parseUrl(const std::string& urlString);
+
+private:
+	enum State : char { WaitStatusLine, RetrievingStatusLine, WaitEndOfHeaders } status;
+
+	uint8_t nextByteToMatch;
+
+	std::string url;
+
+	TrackedMemory memoryUsage;
+};
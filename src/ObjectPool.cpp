@@ -0,0 +1,123 @@
+#include "ObjectPool.h"
+#include "Console/ConsoleCommands.h"
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+void ObjectPoolBase::init() {
+	ConsoleCommands::get()->addCommand("mem.pools",
+	                                   "pools",
+	                                   0,
+	                                   0,
+	                                   &commandList,
+	                                   "List object pools usage",
+	                                   "mem.pools : list used and free objects of each object pool");
+}
+
+std::vector<ObjectPoolBase*>& ObjectPoolBase::getPools() {
+	static std::vector<ObjectPoolBase*> pools;
+	return pools;
+}
+
+uv_mutex_t* ObjectPoolBase::getPoolsLock() {
+	struct PoolsLock {
+		uv_mutex_t lock;
+		PoolsLock() { uv_mutex_init(&lock); }
+	};
+	static PoolsLock poolsLock;
+	return &poolsLock.lock;
+}
+
+ObjectPoolBase::ObjectPoolBase(const char* name, size_t objectSize, size_t objectsPerSlab)
+    : name(name), objectSize(objectSize), objectsPerSlab(objectsPerSlab), freeBlocks(nullptr), usedCount(0) {
+	const size_t alignment = alignof(std::max_align_t);
+
+	blockSize = std::max(objectSize, sizeof(FreeBlock));
+	blockSize = (blockSize + alignment - 1) / alignment * alignment;
+
+	uv_mutex_init(&lock);
+
+	uv_mutex_lock(getPoolsLock());
+	getPools().push_back(this);
+	uv_mutex_unlock(getPoolsLock());
+}
+
+ObjectPoolBase::~ObjectPoolBase() {
+	uv_mutex_lock(getPoolsLock());
+	std::vector<ObjectPoolBase*>& pools = getPools();
+	pools.erase(std::remove(pools.begin(), pools.end(), this), pools.end());
+	uv_mutex_unlock(getPoolsLock());
+
+	for(size_t i = 0; i < slabs.size(); i++)
+		::operator delete(slabs[i]);
+	uv_mutex_destroy(&lock);
+}
+
+void ObjectPoolBase::addSlab() {
+	char* slab = static_cast<char*>(::operator new(objectsPerSlab * blockSize));
+
+	slabs.push_back(slab);
+
+	// Link blocks so the first block of the slab is used first
+	for(size_t i = objectsPerSlab; i > 0; i--) {
+		FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * blockSize);
+		block->next = freeBlocks;
+		freeBlocks = block;
+	}
+}
+
+void* ObjectPoolBase::allocate(size_t size) {
+	if(size > objectSize)
+		return nullptr;
+
+	uv_mutex_lock(&lock);
+
+	if(!freeBlocks)
+		addSlab();
+
+	FreeBlock* block = freeBlocks;
+	freeBlocks = block->next;
+	usedCount++;
+
+	uv_mutex_unlock(&lock);
+
+	return block;
+}
+
+bool ObjectPoolBase::deallocate(void* ptr, size_t size) {
+	if(!ptr)
+		return true;
+
+	if(size > objectSize)
+		return false;
+
+	FreeBlock* block = static_cast<FreeBlock*>(ptr);
+
+	uv_mutex_lock(&lock);
+	block->next = freeBlocks;
+	freeBlocks = block;
+	usedCount--;
+	uv_mutex_unlock(&lock);
+
+	return true;
+}
+
+void ObjectPoolBase::commandList(IWritableConsole* console, const std::vector<std::string>& args) {
+	uv_mutex_lock(getPoolsLock());
+
+	const std::vector<ObjectPoolBase*>& pools = getPools();
+	for(size_t i = 0; i < pools.size(); i++) {
+		ObjectPoolBase* pool = pools[i];
+
+		uv_mutex_lock(&pool->lock);
+		console->writef("%s: used: %llu, free: %llu, slabs: %llu, allocated: %llu KB\r\n",
+		                pool->getName(),
+		                (unsigned long long) pool->getUsedCount(),
+		                (unsigned long long) pool->getFreeCount(),
+		                (unsigned long long) pool->getSlabCount(),
+		                (unsigned long long) (pool->getAllocatedBytes() / 1024));
+		uv_mutex_unlock(&pool->lock);
+	}
+
+	uv_mutex_unlock(getPoolsLock());
+}
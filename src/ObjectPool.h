@@ -0,0 +1,75 @@
+#pragma once
+
+#include "uv.h"
+#include <new>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+class IWritableConsole;
+
+// Memory pool for objects of the same size created and deleted at a high rate.
+// Blocks are carved out of slabs of contiguous blocks and a freed block is the next one reused (LIFO), so recently used
+// memory stays in cache. Slabs are kept until the pool is destroyed.
+// Thread safe.
+class ObjectPoolBase {
+public:
+	ObjectPoolBase(const char* name, size_t objectSize, size_t objectsPerSlab);
+	~ObjectPoolBase();
+
+	static void init();
+
+	// Return null if size is larger than the pool object size
+	void* allocate(size_t size);
+	// Return false if ptr was not allocated by this pool
+	bool deallocate(void* ptr, size_t size);
+
+	const char* getName() const { return name; }
+	size_t getUsedCount() const { return usedCount; }
+	size_t getFreeCount() const { return slabs.size() * objectsPerSlab - usedCount; }
+	size_t getSlabCount() const { return slabs.size(); }
+	size_t getAllocatedBytes() const { return slabs.size() * objectsPerSlab * blockSize; }
+
+protected:
+	static void commandList(IWritableConsole* console, const std::vector<std::string>& args);
+
+private:
+	struct FreeBlock {
+		FreeBlock* next;
+	};
+
+	static std::vector<ObjectPoolBase*>& getPools();
+	static uv_mutex_t* getPoolsLock();
+
+	void addSlab();
+
+	const char* name;
+	size_t objectSize;
+	size_t blockSize;
+	size_t objectsPerSlab;
+
+	uv_mutex_t lock;
+	FreeBlock* freeBlocks;
+	std::vector<char*> slabs;
+	size_t usedCount;
+};
+
+// Pool for objects of type T. T should use it in its operator new and operator delete:
+//   static void* operator new(size_t size) { return ObjectPool<T>::allocateObject(pool, size); }
+//   static void operator delete(void* ptr, size_t size) { ObjectPool<T>::deallocateObject(pool, ptr, size); }
+// Objects are constructed in place by new, so there is nothing to change where they are created.
+template<class T, size_t OBJECTS_PER_SLAB = 256> class ObjectPool : public ObjectPoolBase {
+public:
+	explicit ObjectPool(const char* name) : ObjectPoolBase(name, sizeof(T), OBJECTS_PER_SLAB) {}
+
+	// Derived classes larger than T are allocated with the global operator new
+	static void* allocateObject(ObjectPool& pool, size_t size) {
+		void* ptr = pool.allocate(size);
+		return ptr ? ptr : ::operator new(size);
+	}
+
+	static void deallocateObject(ObjectPool& pool, void* ptr, size_t size) {
+		if(!pool.deallocate(ptr, size))
+			::operator delete(ptr);
+	}
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+// Hash set of pointers with open addressing (linear probing) and backward shift deletion, so there are no tombstones.
+// The key is part of the pointed object: Hash and Equal get it from there. They also accept lookup keys (transparent
+// lookup), find and erase are templates for that:
+//   Hash()(const T*) and Hash()(const LookupKey&) must return the same hash for the same key
+//   Equal()(const T*, const LookupKey&) compares the object's key with the lookup key
+// Each entry is only a pointer and its hash, stored inline in one array: no allocation per entry.
+// Not thread safe.
+template<class T, class Hash, class Equal> class OpenHashSet {
+public:
+	explicit OpenHashSet(size_t initialCapacity = 16) : count(0) { rehash(initialCapacity); }
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+
+	template<class LookupKey> T* find(const LookupKey& key) const {
+		size_t index;
+		if(!findIndex(key, Hash()(key), &index))
+			return nullptr;
+
+		return slots[index].value;
+	}
+
+	// Return false and don't change anything if an object with the same key is already in the set
+	bool insert(T* value) {
+		size_t hash = Hash()(value);
+		size_t index;
+
+		if(findIndex(value, hash, &index))
+			return false;
+
+		if((count + 1) * 4 > slots.size() * 3)
+			rehash(slots.size() * 2);
+
+		insertNew(value, hash);
+		return true;
+	}
+
+	template<class LookupKey> bool erase(const LookupKey& key) {
+		size_t index;
+		if(!findIndex(key, Hash()(key), &index))
+			return false;
+
+		eraseAt(index);
+		return true;
+	}
+
+	// Memory used by the set itself (not the pointed objects)
+	size_t getAllocatedBytes() const { return slots.capacity() * sizeof(Slot); }
+
+private:
+	struct Slot {
+		T* value;  // null if unused
+		size_t hash;
+
+		Slot() : value(nullptr), hash(0) {}
+	};
+
+	template<class LookupKey> bool findIndex(const LookupKey& key, size_t hash, size_t* index) const {
+		size_t mask = slots.size() - 1;
+
+		for(size_t i = hash & mask;; i = (i + 1) & mask) {
+			const Slot& slot = slots[i];
+
+			if(!slot.value)
+				return false;
+
+			if(slot.hash == hash && Equal()(slot.value, key)) {
+				*index = i;
+				return true;
+			}
+		}
+	}
+
+	void insertNew(T* value, size_t hash) {
+		size_t mask = slots.size() - 1;
+		size_t i = hash & mask;
+
+		while(slots[i].value)
+			i = (i + 1) & mask;
+
+		slots[i].value = value;
+		slots[i].hash = hash;
+		count++;
+	}
+
+	void eraseAt(size_t index) {
+		size_t mask = slots.size() - 1;
+		size_t hole = index;
+
+		// Move back following entries of the probe sequence so lookups never stop on the hole
+		for(size_t i = (hole + 1) & mask; slots[i].value; i = (i + 1) & mask) {
+			size_t idealIndex = slots[i].hash & mask;
+
+			// Entries whose ideal index is between the hole and themselves must stay after the hole
+			bool canMove = hole <= i ? (idealIndex <= hole || idealIndex > i) : (idealIndex <= hole && idealIndex > i);
+			if(canMove) {
+				slots[hole] = slots[i];
+				hole = i;
+			}
+		}
+
+		slots[hole] = Slot();
+		count--;
+	}
+
+	void rehash(size_t newCapacity) {
+		size_t capacity = 16;
+		while(capacity < newCapacity)
+			capacity *= 2;
+
+		std::vector<Slot> oldSlots(capacity);
+		oldSlots.swap(slots);
+		count = 0;
+
+		for(size_t i = 0; i < oldSlots.size(); i++) {
+			if(oldSlots[i].value)
+				insertNew(oldSlots[i].value, oldSlots[i].hash);
+		}
+	}
+
+	std::vector<Slot> slots;
+	size_t count;
+};
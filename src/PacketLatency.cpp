@@ -0,0 +1,148 @@
+#include "PacketLatency.h"
+#include "Console/ConsoleCommands.h"
+#include <algorithm>
+#include <string.h>
+
+static const char* const SESSION_TYPE_NAMES[PacketLatency::SessionTypeCount] = {
+    "auth.clients", "auth.gameserver", "upload.clients", "upload.gameserver"};
+static const char* const KIND_NAMES[PacketLatency::KindCount] = {"handler", "response"};
+
+PacketLatency::HistogramMap PacketLatency::histograms[PacketLatency::SessionTypeCount][PacketLatency::KindCount];
+
+int LatencyHistogram::getBucketIndex(uint64_t value) {
+	if(value < (uint64_t) SUB_BUCKET_COUNT)
+		return (int) value;
+
+	int highestBit = 63;
+#if defined(__GNUC__)
+	highestBit = 63 - __builtin_clzll(value);
+#else
+	while(!(value >> highestBit))
+		highestBit--;
+#endif
+
+	// Keep the SUB_BUCKET_BITS bits after the highest one
+	int shift = highestBit - SUB_BUCKET_BITS;
+	return ((shift + 1) << SUB_BUCKET_BITS) + (int) ((value >> shift) & (SUB_BUCKET_COUNT - 1));
+}
+
+uint64_t LatencyHistogram::getBucketHighestValue(int index) {
+	if(index < 2 * SUB_BUCKET_COUNT)
+		return index;
+
+	int shift = (index >> SUB_BUCKET_BITS) - 1;
+	uint64_t lowestValue = (uint64_t) ((index & (SUB_BUCKET_COUNT - 1)) | SUB_BUCKET_COUNT) << shift;
+	return lowestValue + ((uint64_t) 1 << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+	buckets[getBucketIndex(value)]++;
+	count++;
+	total += value;
+	if(value > max)
+		max = value;
+}
+
+void LatencyHistogram::reset() {
+	memset(buckets, 0, sizeof(buckets));
+	count = 0;
+	total = 0;
+	max = 0;
+}
+
+uint64_t LatencyHistogram::getPercentile(double percentile) const {
+	if(count == 0)
+		return 0;
+
+	uint64_t rank = (uint64_t) (count * percentile / 100.0 + 0.5);
+	uint64_t cumulatedCount = 0;
+
+	if(rank < 1)
+		rank = 1;
+
+	for(int i = 0; i < BUCKET_COUNT; i++) {
+		cumulatedCount += buckets[i];
+		if(cumulatedCount >= rank)
+			return std::min(getBucketHighestValue(i), max);
+	}
+
+	return max;
+}
+
+void PacketLatency::init() {
+	ConsoleCommands::get()->addCommand(
+	    "packet.latency",
+	    "packetlatency",
+	    0,
+	    1,
+	    &commandList,
+	    "Show packet handlers latency",
+	    "packet.latency [server_name] : show handler and response latency percentiles of each packet ID, server_name "
+	    "is auth.clients, auth.gameserver, upload.clients or upload.gameserver");
+	ConsoleCommands::get()->addCommand("packet.latency.reset",
+	                                   "packetlatencyreset",
+	                                   0,
+	                                   0,
+	                                   &commandReset,
+	                                   "Reset packet handlers latency",
+	                                   "packet.latency.reset : reset all packet latency histograms");
+}
+
+void PacketLatency::record(SessionType sessionType, Kind kind, uint16_t packetId, uint64_t duration) {
+	HistogramMap& packetHistograms = histograms[sessionType][kind];
+	auto it = packetHistograms.find(packetId);
+
+	if(it == packetHistograms.end()) {
+		// Each histogram is about 2KB, don't let a session grow the memory usage without limit
+		if(packetHistograms.size() >= MAX_PACKET_IDS)
+			return;
+		it = packetHistograms.emplace(packetId, LatencyHistogram()).first;
+	}
+
+	it->second.record(duration);
+}
+
+void PacketLatency::commandList(IWritableConsole* console, const std::vector<std::string>& args) {
+	for(int sessionType = 0; sessionType < SessionTypeCount; sessionType++) {
+		if(!args.empty() && args[0] != SESSION_TYPE_NAMES[sessionType])
+			continue;
+
+		for(int kind = 0; kind < KindCount; kind++) {
+			const HistogramMap& packetHistograms = histograms[sessionType][kind];
+			std::vector<uint16_t> packetIds;
+
+			if(packetHistograms.empty())
+				continue;
+
+			for(auto it = packetHistograms.begin(); it != packetHistograms.end(); ++it)
+				packetIds.push_back(it->first);
+			std::sort(packetIds.begin(), packetIds.end());
+
+			console->writef("%s %s latency (us):\r\n", SESSION_TYPE_NAMES[sessionType], KIND_NAMES[kind]);
+			console->writef("packet      count       mean        p50        p90        p99      p99.9        max\r\n");
+
+			for(size_t i = 0; i < packetIds.size(); i++) {
+				const LatencyHistogram& histogram = packetHistograms.at(packetIds[i]);
+
+				console->writef("%6u %10llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\r\n",
+				                (unsigned int) packetIds[i],
+				                (unsigned long long) histogram.getCount(),
+				                histogram.getMean() / 1000.0,
+				                histogram.getPercentile(50) / 1000.0,
+				                histogram.getPercentile(90) / 1000.0,
+				                histogram.getPercentile(99) / 1000.0,
+				                histogram.getPercentile(99.9) / 1000.0,
+				                histogram.getMax() / 1000.0);
+			}
+		}
+	}
+}
+
+void PacketLatency::commandReset(IWritableConsole* console, const std::vector<std::string>& args) {
+	for(int sessionType = 0; sessionType < SessionTypeCount; sessionType++) {
+		for(int kind = 0; kind < KindCount; kind++)
+			histograms[sessionType][kind].clear();
+	}
+
+	console->writef("Packet latency histograms reset\r\n");
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class IWritableConsole;
+
+// Log-linear histogram of durations in ns (like HdrHistogram with 3 significant bits): values are counted in
+// 8 sub-buckets per power of 2, so a reported percentile is at most 12.5% above the real value.
+// Recording is a few instructions with a fixed memory usage.
+class LatencyHistogram {
+public:
+	LatencyHistogram() { reset(); }
+
+	void record(uint64_t value);
+	void reset();
+
+	uint64_t getCount() const { return count; }
+	uint64_t getMax() const { return max; }
+	uint64_t getMean() const { return count ? total / count : 0; }
+	// Highest value of the bucket containing the percentile (0 to 100)
+	uint64_t getPercentile(double percentile) const;
+
+private:
+	static const int SUB_BUCKET_BITS = 3;
+	static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+	static const int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+	static int getBucketIndex(uint64_t value);
+	static uint64_t getBucketHighestValue(int index);
+
+	uint32_t buckets[BUCKET_COUNT];
+	uint64_t count;
+	uint64_t total;
+	uint64_t max;
+};
+
+// Latency histograms per session type and packet ID:
+//  - handler: time spent in onPacketReceived
+//  - response: time from the request packet to its response for handlers waiting for a DB query or a worker thread
+// Shown with the packet.latency console command and reset with packet.latency.reset.
+// Only packets handled by a session are recorded, with at most MAX_PACKET_IDS packet IDs per session type and kind.
+// Not thread safe, must be used from the main event loop only (like sessions)
+class PacketLatency {
+public:
+	enum SessionType { AuthClient, AuthGame, UploadClient, UploadGame, SessionTypeCount };
+	enum Kind { Handler, Response, KindCount };
+
+	static void init();
+
+	static void record(SessionType sessionType, Kind kind, uint16_t packetId, uint64_t duration);
+
+protected:
+	static void commandList(IWritableConsole* console, const std::vector<std::string>& args);
+	static void commandReset(IWritableConsole* console, const std::vector<std::string>& args);
+
+private:
+	static const size_t MAX_PACKET_IDS = 64;
+
+	typedef std::unordered_map<uint16_t, LatencyHistogram> HistogramMap;
+
+	static HistogramMap histograms[SessionTypeCount][KindCount];
+};
@@ -0,0 +1,238 @@
+#include "SaltedMd5.h"
+#include <openssl/evp.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SALTEDMD5_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef SALTEDMD5_USE_SSE2
+namespace {
+
+const uint32_t MD5_CONSTANTS[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391};
+
+const size_t LANES = 4;
+
+#define MD5_LANES_F(x, y, z) _mm_or_si128(_mm_and_si128(x, y), _mm_andnot_si128(x, z))
+#define MD5_LANES_G(x, y, z) _mm_or_si128(_mm_and_si128(z, x), _mm_andnot_si128(z, y))
+#define MD5_LANES_H(x, y, z) _mm_xor_si128(_mm_xor_si128(x, y), z)
+#define MD5_LANES_I(x, y, z) _mm_xor_si128(y, _mm_or_si128(x, _mm_xor_si128(z, ones)))
+
+#define MD5_LANES_STEP(function, a, b, c, d, wordIndex, step, shift) \
+	a = _mm_add_epi32(_mm_add_epi32(a, function(b, c, d)), \
+	                  _mm_add_epi32(words[wordIndex], _mm_set1_epi32((int) MD5_CONSTANTS[step]))); \
+	a = _mm_add_epi32(b, _mm_or_si128(_mm_slli_epi32(a, shift), _mm_srli_epi32(a, 32 - shift)))
+
+// One MD5 block for each of the 4 lanes, blocks are already padded
+void md5Lanes(const unsigned char blocks[LANES][64], uint32_t states[LANES][4]) {
+	__m128i words[16];
+	const __m128i ones = _mm_set1_epi32(-1);
+
+	for(size_t i = 0; i < 16; i++) {
+		uint32_t laneWords[LANES];
+
+		for(size_t lane = 0; lane < LANES; lane++)
+			memcpy(&laneWords[lane], blocks[lane] + i * 4, 4);
+
+		words[i] = _mm_set_epi32(laneWords[3], laneWords[2], laneWords[1], laneWords[0]);
+	}
+
+	__m128i a = _mm_set_epi32(states[3][0], states[2][0], states[1][0], states[0][0]);
+	__m128i b = _mm_set_epi32(states[3][1], states[2][1], states[1][1], states[0][1]);
+	__m128i c = _mm_set_epi32(states[3][2], states[2][2], states[1][2], states[0][2]);
+	__m128i d = _mm_set_epi32(states[3][3], states[2][3], states[1][3], states[0][3]);
+	__m128i initialA = a, initialB = b, initialC = c, initialD = d;
+
+	for(int i = 0; i < 16; i += 4) {
+		MD5_LANES_STEP(MD5_LANES_F, a, b, c, d, i, i, 7);
+		MD5_LANES_STEP(MD5_LANES_F, d, a, b, c, i + 1, i + 1, 12);
+		MD5_LANES_STEP(MD5_LANES_F, c, d, a, b, i + 2, i + 2, 17);
+		MD5_LANES_STEP(MD5_LANES_F, b, c, d, a, i + 3, i + 3, 22);
+	}
+	for(int i = 16; i < 32; i += 4) {
+		MD5_LANES_STEP(MD5_LANES_G, a, b, c, d, (5 * i + 1) % 16, i, 5);
+		MD5_LANES_STEP(MD5_LANES_G, d, a, b, c, (5 * i + 6) % 16, i + 1, 9);
+		MD5_LANES_STEP(MD5_LANES_G, c, d, a, b, (5 * i + 11) % 16, i + 2, 14);
+		MD5_LANES_STEP(MD5_LANES_G, b, c, d, a, (5 * i + 16) % 16, i + 3, 20);
+	}
+	for(int i = 32; i < 48; i += 4) {
+		MD5_LANES_STEP(MD5_LANES_H, a, b, c, d, (3 * i + 5) % 16, i, 4);
+		MD5_LANES_STEP(MD5_LANES_H, d, a, b, c, (3 * i + 8) % 16, i + 1, 11);
+		MD5_LANES_STEP(MD5_LANES_H, c, d, a, b, (3 * i + 11) % 16, i + 2, 16);
+		MD5_LANES_STEP(MD5_LANES_H, b, c, d, a, (3 * i + 14) % 16, i + 3, 23);
+	}
+	for(int i = 48; i < 64; i += 4) {
+		MD5_LANES_STEP(MD5_LANES_I, a, b, c, d, (7 * i) % 16, i, 6);
+		MD5_LANES_STEP(MD5_LANES_I, d, a, b, c, (7 * i + 7) % 16, i + 1, 10);
+		MD5_LANES_STEP(MD5_LANES_I, c, d, a, b, (7 * i + 14) % 16, i + 2, 15);
+		MD5_LANES_STEP(MD5_LANES_I, b, c, d, a, (7 * i + 21) % 16, i + 3, 21);
+	}
+
+	__m128i results[4] = {_mm_add_epi32(a, initialA),
+	                      _mm_add_epi32(b, initialB),
+	                      _mm_add_epi32(c, initialC),
+	                      _mm_add_epi32(d, initialD)};
+
+	for(size_t i = 0; i < 4; i++) {
+		uint32_t laneValues[LANES];
+
+		_mm_storeu_si128((__m128i*) laneValues, results[i]);
+		for(size_t lane = 0; lane < LANES; lane++)
+			states[lane][i] = laneValues[lane];
+	}
+}
+
+#undef MD5_LANES_F
+#undef MD5_LANES_G
+#undef MD5_LANES_H
+#undef MD5_LANES_I
+#undef MD5_LANES_STEP
+
+}  // namespace
+#endif
+
+SaltedMd5::SaltedMd5() : saltContext(EVP_MD_CTX_new()), hashContext(EVP_MD_CTX_new()) {
+	setSalt(std::string());
+}
+
+SaltedMd5::SaltedMd5(const std::string& salt) : saltContext(EVP_MD_CTX_new()), hashContext(EVP_MD_CTX_new()) {
+	setSalt(salt);
+}
+
+SaltedMd5::~SaltedMd5() {
+	EVP_MD_CTX_free(hashContext);
+	EVP_MD_CTX_free(saltContext);
+}
+
+void SaltedMd5::setSalt(const std::string& salt) {
+	this->salt = salt;
+
+	EVP_DigestInit_ex(saltContext, EVP_md5(), nullptr);
+	EVP_DigestUpdate(saltContext, salt.c_str(), salt.size());
+}
+
+void SaltedMd5::hash(const void* data, size_t size, unsigned char digest[DIGEST_SIZE]) const {
+	EVP_MD_CTX_copy_ex(hashContext, saltContext);
+	EVP_DigestUpdate(hashContext, data, size);
+	EVP_DigestFinal_ex(hashContext, digest, nullptr);
+}
+
+bool SaltedMd5::hasSimdSupport() {
+#ifdef SALTEDMD5_USE_SSE2
+	return true;
+#else
+	return false;
+#endif
+}
+
+void SaltedMd5::hashMultiple(const void* const* data,
+                             const size_t* sizes,
+                             unsigned char (*digests)[DIGEST_SIZE],
+                             size_t count) const {
+#ifdef SALTEDMD5_USE_SSE2
+	const void* laneData[LANES];
+	size_t laneSizes[LANES];
+	size_t laneIndexes[LANES];
+	unsigned char laneDigests[LANES][DIGEST_SIZE];
+	size_t laneCount = 0;
+
+	for(size_t i = 0; i < count; i++) {
+		// Only messages with their padding in one block are done in lanes
+		if(salt.size() + sizes[i] > 55) {
+			hash(data[i], sizes[i], digests[i]);
+			continue;
+		}
+
+		laneData[laneCount] = data[i];
+		laneSizes[laneCount] = sizes[i];
+		laneIndexes[laneCount] = i;
+		laneCount++;
+
+		if(laneCount == LANES) {
+			hashLanes(laneData, laneSizes, laneDigests);
+			for(size_t lane = 0; lane < LANES; lane++)
+				memcpy(digests[laneIndexes[lane]], laneDigests[lane], DIGEST_SIZE);
+			laneCount = 0;
+		}
+	}
+
+	// Not enough messages to fill all lanes
+	for(size_t lane = 0; lane < laneCount; lane++)
+		hash(laneData[lane], laneSizes[lane], digests[laneIndexes[lane]]);
+#else
+	for(size_t i = 0; i < count; i++)
+		hash(data[i], sizes[i], digests[i]);
+#endif
+}
+
+void SaltedMd5::hashLanes(const void* const* data, const size_t* sizes, unsigned char (*digests)[DIGEST_SIZE]) const {
+#ifdef SALTEDMD5_USE_SSE2
+	unsigned char blocks[LANES][64];
+	uint32_t states[LANES][4];
+
+	for(size_t lane = 0; lane < LANES; lane++) {
+		unsigned char* block = blocks[lane];
+		uint64_t bitSize = (uint64_t)(salt.size() + sizes[lane]) * 8;
+
+		memset(block, 0, 64);
+		memcpy(block, salt.c_str(), salt.size());
+		memcpy(block + salt.size(), data[lane], sizes[lane]);
+		block[salt.size() + sizes[lane]] = 0x80;
+		for(size_t i = 0; i < 8; i++)
+			block[56 + i] = (unsigned char) (bitSize >> (i * 8));
+
+		states[lane][0] = 0x67452301;
+		states[lane][1] = 0xefcdab89;
+		states[lane][2] = 0x98badcfe;
+		states[lane][3] = 0x10325476;
+	}
+
+	md5Lanes(blocks, states);
+
+	for(size_t lane = 0; lane < LANES; lane++) {
+		for(size_t i = 0; i < 4; i++) {
+			digests[lane][i * 4] = (unsigned char) states[lane][i];
+			digests[lane][i * 4 + 1] = (unsigned char) (states[lane][i] >> 8);
+			digests[lane][i * 4 + 2] = (unsigned char) (states[lane][i] >> 16);
+			digests[lane][i * 4 + 3] = (unsigned char) (states[lane][i] >> 24);
+		}
+	}
+#endif
+}
+
+void SaltedMd5::toHex(const unsigned char digest[DIGEST_SIZE], char hex[HEX_SIZE]) {
+#ifdef SALTEDMD5_USE_SSE2
+	const __m128i lowNibbleMask = _mm_set1_epi8(0x0F);
+	const __m128i nine = _mm_set1_epi8(9);
+	__m128i value = _mm_loadu_si128((const __m128i*) digest);
+	__m128i high = _mm_and_si128(_mm_srli_epi16(value, 4), lowNibbleMask);
+	__m128i low = _mm_and_si128(value, lowNibbleMask);
+
+	// Most significant nibble first
+	__m128i nibbles[2] = {_mm_unpacklo_epi8(high, low), _mm_unpackhi_epi8(high, low)};
+
+	for(size_t i = 0; i < 2; i++) {
+		// '0' + n for 0-9, 'a' + n - 10 for 10-15
+		__m128i letterOffset = _mm_and_si128(_mm_cmpgt_epi8(nibbles[i], nine), _mm_set1_epi8('a' - '0' - 10));
+		__m128i chars = _mm_add_epi8(_mm_add_epi8(nibbles[i], _mm_set1_epi8('0')), letterOffset);
+		_mm_storeu_si128((__m128i*) (hex + i * 16), chars);
+	}
+#else
+	static const char HEX_DIGITS[] = "0123456789abcdef";
+
+	for(size_t i = 0; i < DIGEST_SIZE; i++) {
+		hex[i * 2] = HEX_DIGITS[digest[i] >> 4];
+		hex[i * 2 + 1] = HEX_DIGITS[digest[i] & 0x0F];
+	}
+#endif
+	hex[DIGEST_SIZE * 2] = '\0';
+}
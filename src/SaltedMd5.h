@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+struct evp_md_ctx_st;
+typedef struct evp_md_ctx_st EVP_MD_CTX;
+
+// MD5 of <salt><data> as used for account passwords and security numbers.
+// The salt is processed once when set, then each hash only process the data.
+// Several hashes can be computed together with hashMultiple, which use SSE2 to hash 4 messages at once when available
+// (for messages fitting in one MD5 block) and falls back to OpenSSL EVP MD5 else.
+// A SaltedMd5 instance is not thread safe, use one per thread.
+class SaltedMd5 {
+public:
+	static const size_t DIGEST_SIZE = 16;
+	static const size_t HEX_SIZE = DIGEST_SIZE * 2 + 1;
+
+	SaltedMd5();
+	explicit SaltedMd5(const std::string& salt);
+	~SaltedMd5();
+
+	void setSalt(const std::string& salt);
+	const std::string& getSalt() const { return salt; }
+
+	void hash(const void* data, size_t size, unsigned char digest[DIGEST_SIZE]) const;
+	void hashMultiple(const void* const* data,
+	                  const size_t* sizes,
+	                  unsigned char (*digests)[DIGEST_SIZE],
+	                  size_t count) const;
+
+	// Lower case hexadecimal string with a null terminator
+	static void toHex(const unsigned char digest[DIGEST_SIZE], char hex[HEX_SIZE]);
+
+	// Return true if hashMultiple use SIMD lanes
+	static bool hasSimdSupport();
+
+private:
+	SaltedMd5(const SaltedMd5&) = delete;
+	SaltedMd5& operator=(const SaltedMd5&) = delete;
+
+	void hashLanes(const void* const* data, const size_t* sizes, unsigned char (*digests)[DIGEST_SIZE]) const;
+
+	std::string salt;
+	EVP_MD_CTX* saltContext;  // Context after the salt, copied to hashContext for each hash
+	EVP_MD_CTX* hashContext;
+};
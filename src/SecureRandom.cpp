@@ -0,0 +1,58 @@
+#include "SecureRandom.h"
+#include "Core/Object.h"
+#include <string.h>
+
+#include <openssl/crypto.h>
+#include <openssl/err.h>
+#include <openssl/rand.h>
+
+namespace {
+
+struct RandomBuffer {
+	static const size_t SIZE = 4096;
+
+	unsigned char data[SIZE];
+	size_t position;
+
+	RandomBuffer() : position(SIZE) {}
+	~RandomBuffer() { OPENSSL_cleanse(data, sizeof(data)); }
+
+	bool refill() {
+		if(RAND_bytes(data, (int) sizeof(data)) != 1) {
+			char error[256];
+
+			ERR_error_string_n(ERR_get_error(), error, sizeof(error));
+			Object::logStatic(LL_Error, "SecureRandom", "Failed to generate random bytes: %s\n", error);
+			return false;
+		}
+
+		position = 0;
+		return true;
+	}
+};
+
+thread_local RandomBuffer randomBuffer;
+
+}  // namespace
+
+bool SecureRandom::getBytes(void* data, size_t size) {
+	unsigned char* output = static_cast<unsigned char*>(data);
+
+	while(size > 0) {
+		if(randomBuffer.position >= RandomBuffer::SIZE && !randomBuffer.refill())
+			return false;
+
+		size_t available = RandomBuffer::SIZE - randomBuffer.position;
+		size_t copySize = size < available ? size : available;
+
+		memcpy(output, randomBuffer.data + randomBuffer.position, copySize);
+		// Given bytes must not stay in memory
+		OPENSSL_cleanse(randomBuffer.data + randomBuffer.position, copySize);
+
+		randomBuffer.position += copySize;
+		output += copySize;
+		size -= copySize;
+	}
+
+	return true;
+}
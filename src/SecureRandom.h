@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Cryptographically secure random bytes for keys and one time passwords, from OpenSSL RAND_bytes.
+// Each thread has its own buffer refilled by large blocks, so most calls are only a copy.
+class SecureRandom {
+public:
+	// Return false if OpenSSL failed to generate random bytes, data content is undefined then
+	static bool getBytes(void* data, size_t size);
+
+	template<typename T> static bool get(T* value) { return getBytes(value, sizeof(*value)); }
+};
@@ -0,0 +1,11 @@
+#include "ThreadCipherContext.h"
+#include <memory>
+
+EVP_CIPHER_CTX* ThreadCipherContext::get() {
+	thread_local std::unique_ptr<EVP_CIPHER_CTX, void (*)(EVP_CIPHER_CTX*)> context(nullptr, &EVP_CIPHER_CTX_free);
+
+	if(!context)
+		context.reset(EVP_CIPHER_CTX_new());
+
+	return context.get();
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <openssl/evp.h>
+
+// EVP cipher context owned by the current thread and reused by its crypto operations instead of allocating one each
+// time. It must be (re)initialized with EVP_EncryptInit_ex or EVP_DecryptInit_ex before each use.
+class ThreadCipherContext {
+public:
+	// Return null if the context can't be allocated
+	static EVP_CIPHER_CTX* get();
+};
@@ -1,5 +1,7 @@
 #include "ClientSession.h"
 #include "../GlobalConfig.h"
+#include "../MetricsExporter.h"
+#include "../PacketLatency.h"
 #include "Core/PrintfFormats.h"
 #include "GameServerSession.h"
 #include "UploadRequest.h"
@@ -14,8 +16,11 @@
 
 namespace UploadServer {
 
+static MemoryCounter clientSessionMemory("UploadServer::ClientSession");
+
 ClientSession::ClientSession()
-    : EncryptedSession<PacketSession>(SessionType::UploadClient, SessionPacketOrigin::Server, EPIC_LATEST) {
+    : EncryptedSession<PacketSession>(SessionType::UploadClient, SessionPacketOrigin::Server, EPIC_LATEST),
+      memoryUsage(clientSessionMemory, sizeof(ClientSession)) {
 	currentRequest = nullptr;
 }
 
@@ -25,6 +30,8 @@ ClientSession::~ClientSession() {
 }
 
 EventChain<PacketSession> ClientSession::onPacketReceived(const TS_MESSAGE* packet) {
+	uint64_t startTime = uv_hrtime();
+
 	switch(packet->id) {
 		case TS_CU_LOGIN::packetID:
 			onLogin(static_cast<const TS_CU_LOGIN*>(packet));
@@ -36,9 +43,12 @@ EventChain<PacketSession> ClientSession::onPacketReceived(const TS_MESSAGE* pack
 
 		default:
 			log(LL_Debug, "Unknown packet ID: %d, size: %d\n", packet->id, packet->size);
-			break;
+			// Not recorded, the peer could create a histogram for each packet ID
+			return PacketSession::onPacketReceived(packet);
 	}
 
+	PacketLatency::record(PacketLatency::UploadClient, PacketLatency::Handler, packet->id, uv_hrtime() - startTime);
+
 	return PacketSession::onPacketReceived(packet);
 }
 
@@ -154,6 +164,7 @@ void ClientSession::onUpload(const TS_CU_UPLOAD* packet) {
 	}
 
 	sendPacket(&result);
+	MetricsExporter::get()->countUploadResult(result.result);
 }
 
 bool ClientSession::checkJpegImage(uint32_t length, const unsigned char* data) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../MemoryCounter.h"
 #include "NetSession/EncryptedSession.h"
 #include "NetSession/PacketSession.h"
 
@@ -28,6 +29,8 @@ private:
 	~ClientSession();
 
 	UploadRequest* currentRequest;
+
+	TrackedMemory memoryUsage;
 };
 
 }  // namespace UploadServer
@@ -1,4 +1,5 @@
 #include "GameServerSession.h"
+#include "../PacketLatency.h"
 #include "Core/Utils.h"
 #include "IconServerSession.h"
 #include "UploadRequest.h"
@@ -12,9 +13,11 @@
 namespace UploadServer {
 
 std::unordered_map<std::string, GameServerSession*> GameServerSession::servers;
+static MemoryCounter gameServerSessionMemory("UploadServer::GameServerSession");
 
 GameServerSession::GameServerSession()
-    : PacketSession(SessionType::UploadGame, SessionPacketOrigin::Server, EPIC_LATEST) {}
+    : PacketSession(SessionType::UploadGame, SessionPacketOrigin::Server, EPIC_LATEST),
+      memoryUsage(gameServerSessionMemory, sizeof(GameServerSession)) {}
 
 GameServerSession::~GameServerSession() {
 	if(this->serverName.empty() == false) {
@@ -25,6 +28,8 @@ GameServerSession::~GameServerSession() {
 }
 
 EventChain<PacketSession> GameServerSession::onPacketReceived(const TS_MESSAGE* packet) {
+	uint64_t startTime = uv_hrtime();
+
 	switch(packet->id) {
 		case TS_SU_LOGIN::packetID:
 			onLogin(static_cast<const TS_SU_LOGIN*>(packet));
@@ -36,9 +41,12 @@ EventChain<PacketSession> GameServerSession::onPacketReceived(const TS_MESSAGE*
 
 		default:
 			log(LL_Debug, "Unknown packet ID: %d, size: %d\n", packet->id, packet->size);
-			break;
+			// Not recorded, the peer could create a histogram for each packet ID
+			return PacketSession::onPacketReceived(packet);
 	}
 
+	PacketLatency::record(PacketLatency::UploadGame, PacketLatency::Handler, packet->id, uv_hrtime() - startTime);
+
 	return PacketSession::onPacketReceived(packet);
 }
 
@@ -67,6 +75,7 @@ void GameServerSession::onLogin(const TS_SU_LOGIN* packet) {
 
 		if(insertResult.second) {
 			this->serverName = serverName;
+			memoryUsage.update(sizeof(GameServerSession) + MemoryCounter::getHeapBytes(this->serverName));
 
 			result.result = TS_RESULT_SUCCESS;
 			setDirtyObjectName();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../MemoryCounter.h"
 #include "NetSession/PacketSession.h"
 #include <unordered_map>
 
@@ -28,6 +29,8 @@ private:
 	static std::unordered_map<std::string, GameServerSession*> servers;
 
 	std::string serverName;
+
+	TrackedMemory memoryUsage;
 };
 
 }  // namespace UploadServer
@@ -18,8 +18,9 @@ static const char* const htmlFound = "HTTP/1.1 200 Ok\r\n"
                                      "Content-Length: %ld\r\n"
                                      "\r\n";
 static size_t htmlFoundSize = strlen(htmlFound);
+static MemoryCounter iconServerSessionMemory("UploadServer::IconServerSession");
 
-IconServerSession::IconServerSession() {
+IconServerSession::IconServerSession() : memoryUsage(iconServerSessionMemory, sizeof(IconServerSession)) {
 	this->status = WaitStatusLine;
 	this->nextByteToMatch = 0;
 	this->urlLength = 0;
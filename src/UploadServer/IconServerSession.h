@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../MemoryCounter.h"
 #include "NetSession/SocketSession.h"
 #include <sstream>
 #include <string>
@@ -28,6 +29,8 @@ private:
 
 	std::ostringstream url;
 	uint8_t urlLength;
+
+	TrackedMemory memoryUsage;
 };
 
 }  // namespace UploadServer
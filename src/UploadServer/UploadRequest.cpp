@@ -1,4 +1,6 @@
 #include "UploadRequest.h"
+#include "../MemoryCounter.h"
+#include "../ObjectPool.h"
 #include "GameServerSession.h"
 #include "uv.h"
 #include <time.h>
@@ -7,6 +9,8 @@ namespace UploadServer {
 
 uv_mutex_t UploadRequest::mapLock = initializeLock();
 std::unordered_map<uint32_t, UploadRequest*> UploadRequest::pendingRequests;
+static ObjectPool<UploadRequest> uploadRequestPool("UploadServer::UploadRequest");
+static MemoryCounter uploadRequestMemory("UploadServer::UploadRequest");
 
 uv_mutex_t UploadRequest::initializeLock() {
 	uv_mutex_init(&mapLock);
@@ -25,31 +29,42 @@ UploadRequest::UploadRequest(GameServerSession* gameServer,
       one_time_password(one_time_password),
       timestamp(time(NULL)) {}
 
+void* UploadRequest::operator new(size_t size) {
+	void* ptr = ObjectPool<UploadRequest>::allocateObject(uploadRequestPool, size);
+	uploadRequestMemory.add(size);
+	return ptr;
+}
+
+void UploadRequest::operator delete(void* ptr, size_t size) {
+	if(ptr)
+		uploadRequestMemory.remove(size);
+	ObjectPool<UploadRequest>::deallocateObject(uploadRequestPool, ptr, size);
+}
+
 UploadRequest* UploadRequest::pushRequest(GameServerSession* gameServer,
                                           uint32_t client_id,
                                           uint32_t account_id,
                                           uint32_t guild_sid,
                                           uint32_t one_time_password) {
-	std::pair<std::unordered_map<uint32_t, UploadRequest*>::iterator, bool> result;
-	UploadRequest* oldRequest;
-	UploadRequest* newRequest = new UploadRequest(gameServer, client_id, account_id, guild_sid, one_time_password);
+	std::unordered_map<uint32_t, UploadRequest*>::iterator it;
+	UploadRequest* request;
 
 	uv_mutex_lock(&mapLock);
 
-	result = pendingRequests.insert(std::pair<uint32_t, UploadRequest*>(newRequest->client_id, newRequest));
-	if(result.second == false) {
-		oldRequest = result.first->second;
-
-		oldRequest->one_time_password = newRequest->one_time_password;
-		oldRequest->timestamp = newRequest->timestamp;
-
-		delete newRequest;
-		newRequest = oldRequest;
+	// A request is created only if there is none for this client yet
+	it = pendingRequests.find(client_id);
+	if(it != pendingRequests.end()) {
+		request = it->second;
+		request->one_time_password = one_time_password;
+		request->timestamp = time(NULL);
+	} else {
+		request = new UploadRequest(gameServer, client_id, account_id, guild_sid, one_time_password);
+		pendingRequests.insert(std::pair<uint32_t, UploadRequest*>(client_id, request));
 	}
 
 	uv_mutex_unlock(&mapLock);
 
-	return newRequest;
+	return request;
 }
 
 UploadRequest* UploadRequest::popRequest(uint32_t client_id,
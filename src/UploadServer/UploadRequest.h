@@ -40,6 +40,10 @@ public:
 	static void removeServer(GameServerSession* server);  // remove all requests from this server
 	static unsigned int getClientCount() { return (int) pendingRequests.size(); }
 
+	// Allocated from a pool (see ObjectPool)
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
+
 private:
 	static uv_mutex_t initializeLock();
 
@@ -5,17 +5,32 @@
 #include "Database/DbConnectionPool.h"
 #include "GlobalConfig.h"
 #include "LibRzuInit.h"
+#include "MemoryCounter.h"
+#include "MetricsExporter.h"
+#include "MetricsSession.h"
+#include "ObjectPool.h"
+#include "PacketLatency.h"
 
 #include "NetSession/BanManager.h"
 #include "NetSession/ServersManager.h"
 #include "NetSession/SessionServer.h"
 
+#include "AuthServer/AccountBatcher.h"
+#include "AuthServer/AccountCache.h"
 #include "AuthServer/ClientSession.h"
+#include "AuthServer/CryptoWorkerPool.h"
 #include "AuthServer/DB_Account.h"
 #include "AuthServer/DB_SecurityNoCheck.h"
 #include "AuthServer/DB_UpdateLastServerIdx.h"
+#include "AuthServer/DB_UpdateLastServerIdxBatch.h"
+#include "AuthServer/DbJobStats.h"
+#include "AuthServer/DbWarmup.h"
 #include "AuthServer/GameData.h"
+#include "AuthServer/GameDataTeardown.h"
 #include "AuthServer/GameServerSession.h"
+#include "AuthServer/LastServerIdxUpdater.h"
+#include "AuthServer/LoginTracer.h"
+#include "AuthServer/RsaPublicKeyCache.h"
 
 #include "UploadServer/ClientSession.h"
 #include "UploadServer/GameServerSession.h"
@@ -81,6 +96,17 @@ int main(int argc, char** argv) {
 	AuthServer::DB_Account::init(CONFIG_GET()->auth.client.desKey);
 	AuthServer::DB_SecurityNoCheck::init();
 	AuthServer::GameData::init();
+	AuthServer::GameDataTeardown::init();
+	ObjectPoolBase::init();
+	MemoryCounter::init();
+	PacketLatency::init();
+	AuthServer::CryptoWorkerPool::init();
+	AuthServer::RsaPublicKeyCache::init();
+	AuthServer::AccountBatcher::init();
+	AuthServer::AccountCache::init();
+	AuthServer::LastServerIdxUpdater::init();
+	AuthServer::DbWarmup::init();
+	AuthServer::DbJobStats::init();
 
 	ConfigInfo::get()->init(argc, argv);
 
@@ -111,8 +137,10 @@ int main(int argc, char** argv) {
 	// Make valgrind happy
 	AuthServer::DB_Account::deinit();
 	DbQueryJob<AuthServer::DB_UpdateLastServerIdx>::deinit();
+	DbQueryJob<AuthServer::DB_UpdateLastServerIdxBatchData>::deinit();
 	DbQueryJob<AuthServer::DB_SecurityNoCheckData>::deinit();
 	DbQueryJob<AuthServer::DB_AccountData>::deinit();
+	DbQueryJob<AuthServer::DB_AccountBatchData>::deinit();
 	EventLoop::getInstance()->deleteObjects();
 
 	return 0;
@@ -151,6 +179,11 @@ void runServers(Log* trafficLogger) {
 	                                                                &CONFIG_GET()->upload.game.listener.idleTimeout,
 	                                                                trafficLogger);
 
+	SessionServer<MetricsSession> metricsServer(CONFIG_GET()->metrics.listener.listenIp,
+	                                            CONFIG_GET()->metrics.listener.port,
+	                                            &CONFIG_GET()->metrics.listener.idleTimeout,
+	                                            trafficLogger);
+
 	AuthServer::LogServerClient logServerClient(CONFIG_GET()->logclient.ip, CONFIG_GET()->logclient.port);
 
 	serverManager.addServer("auth.clients", &authClientServer, &CONFIG_GET()->auth.client.listener.autoStart);
@@ -162,8 +195,18 @@ void runServers(Log* trafficLogger) {
 	serverManager.addServer("upload.iconserver", &uploadIconServer, &CONFIG_GET()->upload.icons.listener.autoStart);
 	serverManager.addServer("upload.gameserver", &uploadGameServer, &CONFIG_GET()->upload.game.listener.autoStart);
 
+	serverManager.addServer("metrics", &metricsServer, &CONFIG_GET()->metrics.listener.autoStart);
+
 	ConsoleServer consoleServer(&serverManager);
 
+	AuthServer::CryptoWorkerPool::get()->start(CONFIG_GET()->auth.client.cryptoThreads,
+	                                           CONFIG_GET()->auth.client.cryptoMaxPendingJobs);
+
+	AuthServer::DbWarmup::get()->start();
+	AuthServer::DbJobStats::get()->start();
+	AuthServer::LoginTracer::get()->start();
+	MetricsExporter::get()->start();
+
 	serverManager.start();
 
 	CrashHandler::setTerminateCallback(&onTerminate, &serverManager);
@@ -171,4 +214,19 @@ void runServers(Log* trafficLogger) {
 	EventLoop::getInstance()->run(UV_RUN_DEFAULT);
 
 	CrashHandler::setTerminateCallback(nullptr, nullptr);
+
+	AuthServer::AccountBatcher::get()->stop();
+
+	// Closed handles are released by the next loop run
+	AuthServer::DbWarmup::get()->stop();
+	AuthServer::DbJobStats::get()->stop();
+	AuthServer::CryptoWorkerPool::get()->stop();
+	AuthServer::LoginTracer::get()->stop();
+	MetricsExporter::get()->stop();
+
+	// Run the loop until pending last server updates are written
+	AuthServer::LastServerIdxUpdater::get()->stop();
+	EventLoop::getInstance()->run(UV_RUN_DEFAULT);
+
+	AuthServer::GameDataTeardown::get()->stop();
 }
@@ -0,0 +1,102 @@
+#include "../GlobalConfig.h"
+#include "AuthClient/Flat/TS_AC_RESULT.h"
+#include "Common.h"
+#include "PacketEnums.h"
+#include "RzTest.h"
+#include "gtest/gtest.h"
+
+/*
+ * Account lookups on the auth server with auth.db.batch.enable (see auth-batch-test.opt)
+ */
+
+namespace AuthServer {
+
+static void addAccountScenario(TestConnectionChannel& auth,
+                               const char* account,
+                               const char* password,
+                               uint16_t result,
+                               int32_t loginFlag) {
+	auth.addCallback([account, password](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
+		ASSERT_EQ(TestConnectionChannel::Event::Connection, event.type);
+		AuthServer::sendVersion(channel);
+		AuthServer::sendAccountDES(channel, account, password);
+	});
+
+	auth.addCallback([result, loginFlag](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
+		AuthServer::expectAuthResult(event, result, loginFlag);
+		channel->closeSession();
+	});
+}
+
+TEST(TS_CA_ACCOUNT_BATCH, valid) {
+	RzTest test;
+	TestConnectionChannel auth(
+	    TestConnectionChannel::Client, CONFIG_GET()->authBatch.ip, CONFIG_GET()->authBatch.port, true);
+
+	addAccountScenario(auth, "test3", "admin", TS_RESULT_SUCCESS, TS_AC_RESULT::LSF_EULA_ACCEPTED);
+
+	auth.start();
+	test.addChannel(&auth);
+	test.run();
+}
+
+TEST(TS_CA_ACCOUNT_BATCH, invalid_password) {
+	RzTest test;
+	TestConnectionChannel auth(
+	    TestConnectionChannel::Client, CONFIG_GET()->authBatch.ip, CONFIG_GET()->authBatch.port, true);
+
+	addAccountScenario(auth, "test4", "invalid_password", TS_RESULT_NOT_EXIST, 0);
+
+	auth.start();
+	test.addChannel(&auth);
+	test.run();
+}
+
+TEST(TS_CA_ACCOUNT_BATCH, null_password) {
+	RzTest test;
+	TestConnectionChannel auth(
+	    TestConnectionChannel::Client, CONFIG_GET()->authBatch.ip, CONFIG_GET()->authBatch.port, true);
+
+	addAccountScenario(auth, "testNullPw", "any_password", TS_RESULT_NOT_EXIST, 0);
+
+	auth.start();
+	test.addChannel(&auth);
+	test.run();
+}
+
+TEST(TS_CA_ACCOUNT_BATCH, null_password_empty) {
+	RzTest test;
+	TestConnectionChannel auth(
+	    TestConnectionChannel::Client, CONFIG_GET()->authBatch.ip, CONFIG_GET()->authBatch.port, true);
+
+	addAccountScenario(auth, "testNullPw", "", TS_RESULT_NOT_EXIST, 0);
+
+	auth.start();
+	test.addChannel(&auth);
+	test.run();
+}
+
+// Logins sent at the same time are looked up with the same query (auth.db.batch.window is 100ms)
+TEST(TS_CA_ACCOUNT_BATCH, mixed_batch) {
+	RzTest test;
+	TestConnectionChannel authValid(
+	    TestConnectionChannel::Client, CONFIG_GET()->authBatch.ip, CONFIG_GET()->authBatch.port, true);
+	TestConnectionChannel authInvalidPassword(
+	    TestConnectionChannel::Client, CONFIG_GET()->authBatch.ip, CONFIG_GET()->authBatch.port, true);
+	TestConnectionChannel authNullPassword(
+	    TestConnectionChannel::Client, CONFIG_GET()->authBatch.ip, CONFIG_GET()->authBatch.port, true);
+
+	addAccountScenario(authValid, "test5", "admin", TS_RESULT_SUCCESS, TS_AC_RESULT::LSF_EULA_ACCEPTED);
+	addAccountScenario(authInvalidPassword, "test6", "invalid_password", TS_RESULT_NOT_EXIST, 0);
+	addAccountScenario(authNullPassword, "testNullPw", "admin", TS_RESULT_NOT_EXIST, 0);
+
+	authValid.start();
+	authInvalidPassword.start();
+	authNullPassword.start();
+	test.addChannel(&authValid);
+	test.addChannel(&authInvalidPassword);
+	test.addChannel(&authNullPassword);
+	test.run();
+}
+
+}  // namespace AuthServer
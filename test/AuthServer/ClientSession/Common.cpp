@@ -189,39 +189,46 @@ void addClientLoginToServerListScenario(TestConnectionChannel& auth,
                                         const char* account,
                                         const char* password,
                                         unsigned char* aesKey,
-                                        const char* version) {
+                                        const char* version,
+                                        RSA* rsaKey,
+                                        ClientLoginStepCallback stepCallback) {
 	if(method == AM_Aes) {
-		RSA* rsaCipher = createRSAKey();
+		bool ownsKey = rsaKey == nullptr;
+		RSA* rsaCipher = ownsKey ? createRSAKey() : rsaKey;
 		auth.addCallback([rsaCipher, version](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
 			ASSERT_EQ(TestConnectionChannel::Event::Connection, event.type);
 			sendVersion(channel, version);
 			sendRSAKey(rsaCipher, channel);
 		});
 
-		auth.addCallback(
-		    [rsaCipher, aesKey, account, password](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
-			    const TS_AC_AES_KEY_IV* packet = AGET_PACKET(TS_AC_AES_KEY_IV);
-			    if(aesKey) {
-				    parseAESKey(rsaCipher, packet, aesKey);
-				    sendAccountRSA(aesKey, channel, account, password);
-			    } else {
-				    unsigned char aes_key_iv[32];
-				    parseAESKey(rsaCipher, packet, aes_key_iv);
-				    sendAccountRSA(aes_key_iv, channel, account, password);
-			    }
-			    RSA_free(rsaCipher);
-		    });
+		auth.addCallback([rsaCipher, ownsKey, aesKey, account, password, stepCallback](
+		                     TestConnectionChannel* channel, TestConnectionChannel::Event event) {
+			const TS_AC_AES_KEY_IV* packet = AGET_PACKET(TS_AC_AES_KEY_IV);
+			unsigned char aes_key_iv[32];
+			unsigned char* key = aesKey ? aesKey : aes_key_iv;
+
+			parseAESKey(rsaCipher, packet, key);
+			if(stepCallback)
+				stepCallback(CLS_Handshake);
+			sendAccountRSA(key, channel, account, password);
+			if(ownsKey)
+				RSA_free(rsaCipher);
+		});
 	} else {
-		auth.addCallback(
-		    [account, password, version](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
-			    ASSERT_EQ(TestConnectionChannel::Event::Connection, event.type);
-			    sendVersion(channel, version);
-			    sendAccountDES(channel, account, password);
-		    });
+		auth.addCallback([account, password, version, stepCallback](TestConnectionChannel* channel,
+		                                                            TestConnectionChannel::Event event) {
+			ASSERT_EQ(TestConnectionChannel::Event::Connection, event.type);
+			sendVersion(channel, version);
+			if(stepCallback)
+				stepCallback(CLS_Handshake);
+			sendAccountDES(channel, account, password);
+		});
 	}
 
-	auth.addCallback([](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
+	auth.addCallback([stepCallback](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
 		expectAuthResult(event, TS_RESULT_SUCCESS, TS_AC_RESULT::LSF_EULA_ACCEPTED);
+		if(stepCallback)
+			stepCallback(CLS_Account);
 
 		TS_CA_SERVER_LIST serverListPacket;
 		TS_MESSAGE::initMessage(&serverListPacket);
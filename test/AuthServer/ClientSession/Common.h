@@ -3,6 +3,7 @@
 #include "AuthClient/Flat/TS_AC_AES_KEY_IV.h"
 #include "AuthClient/Flat/TS_CA_ACCOUNT.h"
 #include "TestConnectionChannel.h"
+#include <functional>
 #include <stdint.h>
 
 struct rsa_st;
@@ -39,12 +40,22 @@ void expectAuthResult(TestConnectionChannel::Event& event, uint16_t result, int3
 
 enum AuthMethod { AM_Des, AM_Aes };
 
+// Login steps done, for callers measuring them
+enum ClientLoginStep {
+	CLS_Handshake,  // Version sent and for AES, the AES key received. Called just before sending the account
+	CLS_Account     // Auth result received. Called just before requesting the server list
+};
+typedef std::function<void(ClientLoginStep step)> ClientLoginStepCallback;
+
+// rsaKey is used instead of a new key if not null, it is not freed
 void addClientLoginToServerListScenario(TestConnectionChannel& auth,
                                         AuthMethod method,
                                         const char* account,
                                         const char* password,
                                         unsigned char* aesKey = nullptr,
-                                        const char* version = "201501120");
+                                        const char* version = "201501120",
+                                        RSA* rsaKey = nullptr,
+                                        ClientLoginStepCallback stepCallback = nullptr);
 
 }  // namespace AuthServer
 
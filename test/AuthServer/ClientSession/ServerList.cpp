@@ -1,10 +1,14 @@
 #include "../GameServerSession/Common.h"
 #include "../GlobalConfig.h"
 #include "AuthClient/Flat/TS_AC_RESULT.h"
+#include "AuthClient/Flat/TS_AC_SELECT_SERVER.h"
+#include "AuthClient/Flat/TS_CA_SELECT_SERVER.h"
 #include "AuthClient/Flat/TS_CA_SERVER_LIST.h"
 #include "AuthClient/Flat/TS_CA_VERSION.h"
+#include "AuthGame/TS_AG_CLIENT_LOGIN.h"
 #include "AuthGame/TS_AG_LOGIN_RESULT.h"
 #include "Common.h"
+#include "Core/Timer.h"
 #include "FlatPackets/TS_AC_SERVER_LIST.h"
 #include "PacketEnums.h"
 #include "RzTest.h"
@@ -225,6 +229,68 @@ TEST(TS_CA_SERVER_LIST, two_epic2_gs_list) {
 	test.run();
 }
 
+TEST(TS_CA_SERVER_LIST, list_updated_after_gs_login) {
+	RzTest test;
+	TestConnectionChannel auth(TestConnectionChannel::Client, CONFIG_GET()->auth.ip, CONFIG_GET()->auth.port, true);
+	TestConnectionChannel game1(TestConnectionChannel::Client, CONFIG_GET()->game.ip, CONFIG_GET()->game.port, false);
+	TestConnectionChannel game2(TestConnectionChannel::Client, CONFIG_GET()->game.ip, CONFIG_GET()->game.port, false);
+
+	game1.start();
+
+	addGameLoginScenario(
+	    game1,
+	    5,
+	    "Server 5",
+	    "http://www.example.com/index5.html",
+	    false,
+	    "127.0.0.5",
+	    4705,
+	    [&auth](TestConnectionChannel* channel, TestConnectionChannel::Event event) { auth.start(); });
+
+	addGameLoginScenario(game2,
+	                     6,
+	                     "Server 6",
+	                     "http://www.example.com/index6.html",
+	                     false,
+	                     "127.0.0.6",
+	                     4706,
+	                     [&auth](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
+		                     // Ask again the server list now that a new server is ready
+		                     TS_CA_SERVER_LIST serverListPacket;
+		                     TS_MESSAGE::initMessage(&serverListPacket);
+		                     auth.sendPacket(&serverListPacket);
+	                     });
+
+	addClientLoginToServerListScenario(auth, AM_Aes, "test7", "admin");
+
+	auth.addCallback([&game2](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
+		const TS_AC_SERVER_LIST* packet = AGET_PACKET(TS_AC_SERVER_LIST);
+
+		ASSERT_EQ(1, packet->count);
+		EXPECT_EQ(5, packet->servers[0].server_idx);
+
+		game2.start();
+	});
+
+	auth.addCallback([&game1, &game2](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
+		const TS_AC_SERVER_LIST* packet = AGET_PACKET(TS_AC_SERVER_LIST);
+
+		ASSERT_EQ(2, packet->count);
+		EXPECT_TRUE(packet->servers[0].server_idx == 5 || packet->servers[0].server_idx == 6);
+		EXPECT_TRUE(packet->servers[1].server_idx == 5 || packet->servers[1].server_idx == 6);
+		EXPECT_NE(packet->servers[0].server_idx, packet->servers[1].server_idx);
+
+		channel->closeSession();
+		game1.closeSession();
+		game2.closeSession();
+	});
+
+	test.addChannel(&game1);
+	test.addChannel(&game2);
+	test.addChannel(&auth);
+	test.run();
+}
+
 TEST(TS_CA_SERVER_LIST, non_null_terminated_gs_info) {
 	RzTest test;
 	TestConnectionChannel auth(TestConnectionChannel::Client, CONFIG_GET()->auth.ip, CONFIG_GET()->auth.port, true);
@@ -274,4 +340,89 @@ TEST(TS_CA_SERVER_LIST, non_null_terminated_gs_info) {
 	test.run();
 }
 
+// Start a channel after a delay
+struct DelayedChannelStart {
+	Timer<DelayedChannelStart> timer;
+	TestConnectionChannel* channel;
+
+	void start(TestConnectionChannel* channel, uint64_t delayMs) {
+		this->channel = channel;
+		timer.start(this, &DelayedChannelStart::onTimer, delayMs, 0);
+	}
+
+	void onTimer() { channel->start(); }
+};
+
+// The batch test auth server writes last server updates every 100ms (auth.db.lastserveridx.flushinterval)
+TEST(TS_CA_SERVER_LIST, last_server_idx_after_flush) {
+	RzTest test;
+	TestConnectionChannel auth(
+	    TestConnectionChannel::Client, CONFIG_GET()->authBatch.ip, CONFIG_GET()->authBatch.port, true);
+	TestConnectionChannel authAgain(
+	    TestConnectionChannel::Client, CONFIG_GET()->authBatch.ip, CONFIG_GET()->authBatch.port, true);
+	TestConnectionChannel game(
+	    TestConnectionChannel::Client, CONFIG_GET()->authBatchGame.ip, CONFIG_GET()->authBatchGame.port, false);
+	DelayedChannelStart delayedStart;
+
+	game.start();
+
+	addGameLoginScenario(game,
+	                     14,
+	                     "Server 14",
+	                     "http://www.example.com/index_14.html",
+	                     false,
+	                     "127.0.0.1",
+	                     4514,
+	                     [&auth](TestConnectionChannel* channel, TestConnectionChannel::Event event) { auth.start(); });
+
+	addClientLoginToServerListScenario(auth, AM_Des, "test8", "admin");
+
+	auth.addCallback([](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
+		const TS_AC_SERVER_LIST* packet = AGET_PACKET(TS_AC_SERVER_LIST);
+
+		EXPECT_NE(14, packet->last_login_server_idx);
+
+		TS_CA_SELECT_SERVER selectServerPkt;
+		TS_MESSAGE::initMessage(&selectServerPkt);
+		selectServerPkt.server_idx = 14;
+		channel->sendPacket(&selectServerPkt);
+	});
+
+	auth.addCallback([&game](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
+		const TS_AC_SELECT_SERVER* packet = AGET_PACKET(TS_AC_SELECT_SERVER);
+
+		ASSERT_EQ(TS_RESULT_SUCCESS, packet->result);
+
+		channel->closeSession();
+		sendClientLogin(&game, "test8", packet->one_time_key);
+	});
+
+	game.addCallback([&authAgain, &delayedStart](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
+		const TS_AG_CLIENT_LOGIN* packet = AGET_PACKET(TS_AG_CLIENT_LOGIN);
+
+		ASSERT_EQ(TS_RESULT_SUCCESS, packet->result);
+
+		sendClientLogout(channel, "test8");
+
+		// Login again once the update is written
+		delayedStart.start(&authAgain, 500);
+	});
+
+	addClientLoginToServerListScenario(authAgain, AM_Des, "test8", "admin");
+
+	authAgain.addCallback([&game](TestConnectionChannel* channel, TestConnectionChannel::Event event) {
+		const TS_AC_SERVER_LIST* packet = AGET_PACKET(TS_AC_SERVER_LIST);
+
+		EXPECT_EQ(14, packet->last_login_server_idx);
+
+		channel->closeSession();
+		game.closeSession();
+	});
+
+	test.addChannel(&game);
+	test.addChannel(&auth);
+	test.addChannel(&authAgain);
+	test.run();
+}
+
 }  // namespace AuthServer
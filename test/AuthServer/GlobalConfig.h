@@ -15,7 +15,9 @@ struct ConnectionConfig {
 
 struct GlobalConfig {
 	ConnectionConfig auth;
+	ConnectionConfig authBatch;  // Auth server with batched account lookups
 	ConnectionConfig game;
+	ConnectionConfig authBatchGame;  // Game server port of the auth server with batched account lookups
 	ConnectionConfig billing;
 	cval<std::string>& authExecutable;
 	cval<std::string>& gameReconnectExecutable;
@@ -24,7 +26,9 @@ struct GlobalConfig {
 
 	GlobalConfig()
 	    : auth("auth.clients", 4500),
+	      authBatch("auth.batch.clients", 4510),
 	      game("auth.game", 4502),
+	      authBatchGame("auth.batch.game", 4512),
 	      billing("auth.billing", 4503),
 	      authExecutable(CFG_CREATE("auth.exec", "rzauth")),
 	      gameReconnectExecutable(CFG_CREATE("gamereconnect.exec", "rzgamereconnect")),
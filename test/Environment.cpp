@@ -47,6 +47,7 @@ void Environment::beforeTests() {
 	ASSERT_NE(false, connection->execute("INSERT INTO account VALUES(19,'test19','613b5247e3398350918cb622a3ec19e9',NULL,NULL,NULL);"));
 	ASSERT_NE(false, connection->execute("INSERT INTO account VALUES(20,'test20','613b5247e3398350918cb622a3ec19e9',NULL,NULL,NULL);"));
 	ASSERT_NE(false, connection->execute("INSERT INTO account VALUES(21,'test' || char(233),'613b5247e3398350918cb622a3ec19e9',NULL,NULL,NULL);"));
+	ASSERT_NE(false, connection->execute("INSERT INTO account VALUES(22,'testNullPw',NULL,NULL,NULL,NULL);"));
 	ASSERT_NE(false, connection->execute("INSERT INTO account VALUES(1000000001,'testPw47Chars','c8d8079110d491e6d115dc0755c7e5eb',NULL,NULL,NULL);"));
 	ASSERT_NE(false, connection->execute("INSERT INTO account VALUES(1000000002,'testPw60Chars','33410d89b4a115d9ac9c7aaaff255b91',NULL,NULL,NULL);"));
 	ASSERT_NE(false, connection->execute("INSERT INTO account VALUES(1000000003,'testPw64Chars','0504f832c91bc39001f67f4209f7f077',NULL,NULL,NULL);"));
@@ -59,12 +60,14 @@ void Environment::beforeTests() {
 	connectionStringArg += connectionString;
 
 	spawnProcess(4500, authExec.c_str(), 2, "/configfile:./auth-test.opt", connectionStringArg.c_str());
+	spawnProcess(4510, authExec.c_str(), 2, "/configfile:./auth-batch-test.opt", connectionStringArg.c_str());
 	if(testGameReconnect)
 		spawnProcess(4802, gameReconnectExec.c_str(), 1, "/configfile:./rzgamereconnect-test.opt");
 }
 
 void Environment::afterTests() {
 	stop(4501);
+	stop(4511);
 	if(testGameReconnect)
 		stop(4801);
 }
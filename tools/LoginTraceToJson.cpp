@@ -0,0 +1,188 @@
+#include "AuthServer/LoginTraceFormat.h"
+#include <algorithm>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// Convert a login trace ring file (auth.trace.file) to the Chrome trace event JSON format, to be opened with
+// chrome://tracing or https://ui.perfetto.dev.
+// Each traced login is shown as a thread named "login <trace id>" with one span per stage.
+// Usage: rzauth_trace2json <trace file> [output file] [min login duration in ms]
+// Logins shorter than the min duration are skipped, use it to keep only slow logins.
+
+using namespace AuthServer;
+
+static bool readRecords(const char* fileName, LoginTraceFileHeader* header, std::vector<LoginTraceRecord>* records) {
+	FILE* file = fopen(fileName, "rb");
+
+	if(!file) {
+		fprintf(stderr, "Can't open %s\n", fileName);
+		return false;
+	}
+
+	if(fread(header, sizeof(*header), 1, file) != 1 ||
+	   memcmp(header->magic, LOGIN_TRACE_MAGIC, sizeof(header->magic)) ||
+	   header->recordSize != sizeof(LoginTraceRecord) || header->capacity == 0) {
+		fprintf(stderr, "%s is not a login trace file\n", fileName);
+		fclose(file);
+		return false;
+	}
+
+	// The oldest record is just after the last written one once the ring is full
+	uint64_t count = std::min<uint64_t>(header->writtenRecords, header->capacity);
+	uint64_t first = header->writtenRecords > header->capacity ? header->writtenRecords % header->capacity : 0;
+
+	records->resize((size_t) count);
+	for(uint64_t i = 0; i < count; i++) {
+		uint64_t index = (first + i) % header->capacity;
+
+		if(i == 0 || index == 0)
+			fseek(file, (long) (sizeof(*header) + index * sizeof(LoginTraceRecord)), SEEK_SET);
+		if(fread(&(*records)[(size_t) i], sizeof(LoginTraceRecord), 1, file) != 1) {
+			records->resize((size_t) i);
+			break;
+		}
+	}
+
+	fclose(file);
+	return true;
+}
+
+static void writeEvent(FILE* out, bool* firstEvent, const char* format, ...) {
+	va_list args;
+
+	fputs(*firstEvent ? "\n" : ",\n", out);
+	*firstEvent = false;
+
+	va_start(args, format);
+	vfprintf(out, format, args);
+	va_end(args);
+}
+
+// Write spans of one login, records are sorted by timestamp
+static void writeTrace(
+    FILE* out, bool* firstEvent, uint64_t startTimestamp, const LoginTraceRecord* records, size_t count) {
+	const LoginTraceRecord* openSpans[LTS_Count] = {};
+	uint32_t traceId = records[0].traceId;
+	uint64_t lastTimestamp = records[count - 1].timestamp;
+
+	writeEvent(out,
+	           firstEvent,
+	           "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"login %u\"}}",
+	           traceId,
+	           traceId);
+
+	for(size_t i = 0; i < count; i++) {
+		const LoginTraceRecord& record = records[i];
+		double timestamp = (double) (int64_t) (record.timestamp - startTimestamp) / 1000.0;
+
+		if(record.stage >= LTS_Count)
+			continue;
+
+		if(record.type == LTE_Instant) {
+			writeEvent(out,
+			           firstEvent,
+			           "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,"
+			           "\"args\":{\"thread\":%u}}",
+			           getLoginTraceStageName(record.stage),
+			           traceId,
+			           timestamp,
+			           (unsigned int) record.threadId);
+		} else if(record.type == LTE_Begin) {
+			openSpans[record.stage] = &record;
+		} else if(record.type == LTE_End && openSpans[record.stage]) {
+			// Ends without a begin are ignored (like the DB execution end of queries already ended by a row)
+			const LoginTraceRecord* begin = openSpans[record.stage];
+
+			writeEvent(out,
+			           firstEvent,
+			           "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+			           "\"args\":{\"begin thread\":%u,\"end thread\":%u}}",
+			           getLoginTraceStageName(record.stage),
+			           traceId,
+			           (double) (int64_t) (begin->timestamp - startTimestamp) / 1000.0,
+			           (record.timestamp - begin->timestamp) / 1000.0,
+			           (unsigned int) begin->threadId,
+			           (unsigned int) record.threadId);
+			openSpans[record.stage] = nullptr;
+		}
+	}
+
+	// Spans not ended when the trace was written (or when the connection was closed)
+	for(int stage = 0; stage < LTS_Count; stage++) {
+		const LoginTraceRecord* begin = openSpans[stage];
+
+		if(!begin)
+			continue;
+
+		writeEvent(out,
+		           firstEvent,
+		           "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+		           "\"args\":{\"begin thread\":%u,\"unfinished\":true}}",
+		           getLoginTraceStageName((uint8_t) stage),
+		           traceId,
+		           (double) (int64_t) (begin->timestamp - startTimestamp) / 1000.0,
+		           (lastTimestamp - begin->timestamp) / 1000.0,
+		           (unsigned int) begin->threadId);
+	}
+}
+
+int main(int argc, char** argv) {
+	LoginTraceFileHeader header;
+	std::vector<LoginTraceRecord> records;
+
+	if(argc < 2) {
+		fprintf(stderr, "Usage: %s <trace file> [output file] [min login duration in ms]\n", argv[0]);
+		return 1;
+	}
+
+	if(!readRecords(argv[1], &header, &records))
+		return 1;
+
+	FILE* out = argc > 2 ? fopen(argv[2], "wb") : stdout;
+	uint64_t minDuration = argc > 3 ? (uint64_t) (strtod(argv[3], nullptr) * 1000000) : 0;
+
+	if(!out) {
+		fprintf(stderr, "Can't open %s\n", argv[2]);
+		return 1;
+	}
+
+	// Group records by login, keeping their time order
+	std::stable_sort(records.begin(), records.end(), [](const LoginTraceRecord& a, const LoginTraceRecord& b) {
+		if(a.traceId != b.traceId)
+			return a.traceId < b.traceId;
+		return a.timestamp < b.timestamp;
+	});
+
+	bool firstEvent = true;
+	size_t traceCount = 0;
+
+	fprintf(out,
+	        "{\"otherData\":{\"startUnixTime\":%llu},\"traceEvents\":[",
+	        (unsigned long long) header.startUnixTime);
+
+	for(size_t begin = 0; begin < records.size();) {
+		size_t end = begin + 1;
+
+		while(end < records.size() && records[end].traceId == records[begin].traceId)
+			end++;
+
+		if(records[end - 1].timestamp - records[begin].timestamp >= minDuration) {
+			writeTrace(out, &firstEvent, header.startTimestamp, &records[begin], end - begin);
+			traceCount++;
+		}
+
+		begin = end;
+	}
+
+	fprintf(out, "\n]}\n");
+
+	if(out != stdout)
+		fclose(out);
+
+	fprintf(stderr, "%d records, %d logins written\n", (int) records.size(), (int) traceCount);
+
+	return 0;
+}